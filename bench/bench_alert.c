@@ -0,0 +1,86 @@
+// bench_alert.c
+// Coût de l'évaluation des règles d'alerte : R règles sur H sources de N
+// processus, T instantanés successifs (CPU% et RSS qui varient, quelques pids
+// qui apparaissent et disparaissent à chaque instantané).
+// Usage : bench_alert [règles] [sources] [processus] [instantanés]
+//         (256 11 1000 20 par défaut, sources <= MAX_HOSTS + 1)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "alert.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill_rows(ProcessInfo *rows, int n, int frame) {
+    static const char *users[] = { "root", "postgres", "www-data", "app", "systemd-network" };
+    static const char *names[] = { "java", "postgres", "nginx", "python3", "kworker/3:1-events" };
+    for (int i = 0; i < n; i++) {
+        ProcessInfo *p = &rows[i];
+        memset(p, 0, sizeof(*p));
+        // 1 % des pids changent à chaque instantané
+        p->pid = (i % 100 == 0) ? 100000 + frame * n + i : 1 + i;
+        p->user_id = strpool_intern(users[i % 5], strlen(users[i % 5]));
+        p->name_id = strpool_intern(names[(i / 5) % 5], strlen(names[(i / 5) % 5]));
+        p->state = "RSDIZ"[rand() % 5];
+        p->cpu_percent = (rand() % 10000) / 100.0;
+        p->res = (unsigned long)(rand() % 16384) << 20;
+        p->virt = p->res * 2;
+        p->mem_percent = (rand() % 10000) / 100.0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int nrules = (argc > 1) ? atoi(argv[1]) : 256;
+    int nsources = (argc > 2) ? atoi(argv[2]) : ALERT_MAX_SOURCES;
+    int n = (argc > 3) ? atoi(argv[3]) : 1000;
+    int frames = (argc > 4) ? atoi(argv[4]) : 20;
+    if (nrules <= 0 || nrules > ALERT_MAX_RULES) nrules = 256;
+    if (nsources <= 0 || nsources > ALERT_MAX_SOURCES) nsources = ALERT_MAX_SOURCES;
+    if (n <= 0) n = 1000;
+    if (frames <= 0) frames = 20;
+
+    char rule[128], err[256], name[32];
+    for (int r = 0; r < nrules; r++) {
+        switch (r % 4) {
+            case 0: snprintf(rule, sizeof(rule), "cpu>%d for 30s", 50 + r % 50); break;
+            case 1: snprintf(rule, sizeof(rule), "rss>%dG user=app for 1m", 1 + r % 16); break;
+            case 2: snprintf(rule, sizeof(rule), "name~java mem>%d on host%d", 50 + r % 50, r % 10); break;
+            default: snprintf(rule, sizeof(rule), "state=D cpu>%d for 5s on local", r % 20); break;
+        }
+        if (alert_add_rule(rule, err, sizeof(err)) != 0) {
+            fprintf(stderr, "%s : %s\n", rule, err);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ProcessInfo *rows = malloc(sizeof(ProcessInfo) * n);
+    if (!rows) return EXIT_FAILURE;
+    srand(42);
+    double total = 0;
+    long flagged = 0;
+    int fired = 0;
+    for (int f = 0; f < frames; f++) {
+        for (int s = 0; s < nsources; s++) {
+            int source = s - 1; // -1 : local
+            fill_rows(rows, n, f);
+            snprintf(name, sizeof(name), "%s%d", source < 0 ? "local" : "host", source);
+            double t0 = now_sec();
+            fired += alert_evaluate(source, source < 0 ? "local" : name, rows, n);
+            total += now_sec() - t0;
+            for (int i = 0; i < n; i++) flagged += (rows[i].alert != ALERT_NONE);
+        }
+    }
+
+    double checks = (double)frames * nsources * n * nrules;
+    printf("%d règles, %d sources x %d processus, %d instantanés\n", nrules, nsources, n, frames);
+    printf("  par instantané : %8.3f ms  (%.1f ns par couple processus/règle)\n",
+           total * 1e3 / (frames * nsources), total * 1e9 / checks);
+    printf("  lignes signalées : %ld, déclenchements : %d\n", flagged, fired);
+    free(rows);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,278 @@
+// bench_collect.c
+// Génère un faux /proc (stat, statm, status, io, cgroup par pid, plus stat,
+// meminfo et loadavg à la racine), y pointe la collecte avec
+// process_set_proc_root() et mesure process_collect_all() (complète en pread
+// et io_uring, ou paresseuse pour une page), process_sort_top() et
+// ui_refresh_process_list() (rendu vers /dev/null).
+// Usage : bench_collect [nombre_de_processus ...]   (1000 10000 100000 par défaut)
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include "process.h"
+#include "sysstats.h"
+#include "profile.h"
+#include "ui.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Générateur pseudo-aléatoire fixe : mêmes arborescences d'un lancement à l'autre
+static unsigned int seed = 42;
+static unsigned int next_rand(void) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+static int write_file(const char *dir, const char *name, const char *data, int len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    int ok = (write(fd, data, len) == len);
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+static int write_root_files(const char *root) {
+    char buf[4096];
+    int len = snprintf(buf, sizeof(buf),
+        "cpu  4705 356 584 3699176 23 23 0 0 0 0\n"
+        "cpu0 1393 280 290 924434 10 13 0 0 0 0\n"
+        "cpu1 1109 26 101 925070 3 3 0 0 0 0\n"
+        "cpu2 1147 23 93 925111 6 4 0 0 0 0\n"
+        "cpu3 1056 27 100 924561 4 3 0 0 0 0\n"
+        "intr 114930548 113199788 3 0 5 263 0 4 [...]\n"
+        "ctxt 1990473\nbtime 1062191376\nprocesses 2915\n"
+        "procs_running 1\nprocs_blocked 0\n");
+    if (write_file(root, "stat", buf, len) != 0) return -1;
+    len = snprintf(buf, sizeof(buf),
+        "MemTotal:       16318480 kB\nMemFree:         1920844 kB\n"
+        "MemAvailable:    9411740 kB\nBuffers:          410036 kB\n"
+        "Cached:          6870656 kB\nSwapCached:            0 kB\n"
+        "SwapTotal:       2097148 kB\nSwapFree:        2097148 kB\n");
+    if (write_file(root, "meminfo", buf, len) != 0) return -1;
+    len = snprintf(buf, sizeof(buf), "0.42 0.35 0.30 1/1234 5678\n");
+    return write_file(root, "loadavg", buf, len);
+}
+
+// Contenus calqués sur un noyau 6.x (status complet : c'est le plus gros fichier lu)
+static int write_process(const char *root, int pid, int ppid) {
+    static const char *names[] = { "java", "postgres", "nginx", "python3", "kworker/3:1-events", "sshd" };
+    static const int uids[] = { 0, 0, 33, 65534, 1000 };
+    char dir[512], buf[4096];
+    const char *name = names[next_rand() % 6];
+    int uid = uids[next_rand() % 5];
+    unsigned long utime = next_rand() * 3, stime = next_rand();
+    unsigned long vsize = (unsigned long)(next_rand() + 1) << 14;
+    unsigned long rss = vsize / 4096 >> (next_rand() % 6);
+    int threads = 1 + next_rand() % 8;
+    int nice = (next_rand() % 4 == 0) ? (int)(next_rand() % 40) - 20 : 0;
+
+    snprintf(dir, sizeof(dir), "%s/%d", root, pid);
+    if (mkdir(dir, 0755) != 0) return -1;
+
+    int len = snprintf(buf, sizeof(buf),
+        "%d (%s) S %d %d %d 0 -1 4194560 %u 0 %u 0 %lu %lu 0 0 %d %d %d 0 %u %lu %lu "
+        "18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 17 %d 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+        pid, name, ppid, pid, pid, next_rand(), next_rand() % 50, utime, stime,
+        20 + nice, nice, threads, next_rand() * 100, vsize, rss, pid % 4);
+    if (write_file(dir, "stat", buf, len) != 0) return -1;
+
+    len = snprintf(buf, sizeof(buf), "%lu %lu %lu 1 0 %lu 0\n",
+                   vsize / 4096, rss, rss / 3, rss / 2);
+    if (write_file(dir, "statm", buf, len) != 0) return -1;
+
+    len = snprintf(buf, sizeof(buf),
+        "Name:\t%s\nUmask:\t0022\nState:\tS (sleeping)\nTgid:\t%d\nNgid:\t0\nPid:\t%d\n"
+        "PPid:\t%d\nTracerPid:\t0\nUid:\t%d\t%d\t%d\t%d\nGid:\t%d\t%d\t%d\t%d\n"
+        "FDSize:\t64\nGroups:\t \nNStgid:\t%d\nNSpid:\t%d\nNSpgid:\t%d\nNSsid:\t%d\n"
+        "Kthread:\t0\nVmPeak:\t%8lu kB\nVmSize:\t%8lu kB\nVmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\nVmHWM:\t%8lu kB\nVmRSS:\t%8lu kB\nRssAnon:\t%8lu kB\n"
+        "RssFile:\t%8lu kB\nRssShmem:\t       0 kB\nVmData:\t%8lu kB\nVmStk:\t     132 kB\n"
+        "VmExe:\t     892 kB\nVmLib:\t    5432 kB\nVmPTE:\t     180 kB\nVmSwap:\t       0 kB\n"
+        "HugetlbPages:\t       0 kB\nCoreDumping:\t0\nTHP_enabled:\t1\nuntag_mask:\t0xffffffffffffffff\n"
+        "Threads:\t%d\nSigQ:\t0/63328\nSigPnd:\t0000000000000000\nShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000000000000\nSigIgn:\t0000000000001000\nSigCgt:\t0000000180004a02\n"
+        "CapInh:\t0000000000000000\nCapPrm:\t0000000000000000\nCapEff:\t0000000000000000\n"
+        "CapBnd:\t000001ffffffffff\nCapAmb:\t0000000000000000\nNoNewPrivs:\t0\nSeccomp:\t0\n"
+        "Seccomp_filters:\t0\nSpeculation_Store_Bypass:\tthread vulnerable\n"
+        "SpeculationIndirectBranch:\tconditional enabled\nCpus_allowed:\tff\n"
+        "Cpus_allowed_list:\t0-7\nMems_allowed:\t00000000,00000001\nMems_allowed_list:\t0\n"
+        "voluntary_ctxt_switches:\t%u\nnonvoluntary_ctxt_switches:\t%u\n",
+        name, pid, pid, ppid, uid, uid, uid, uid, uid, uid, uid, uid,
+        pid, pid, pid, pid, vsize / 1024, vsize / 1024, rss * 4, rss * 4, rss * 3,
+        rss, vsize / 2048, threads, next_rand(), next_rand() % 100);
+    if (write_file(dir, "status", buf, len) != 0) return -1;
+
+    len = snprintf(buf, sizeof(buf),
+        "rchar: %u\nwchar: %u\nsyscr: %u\nsyscw: %u\nread_bytes: %u\n"
+        "write_bytes: %u\ncancelled_write_bytes: 0\n",
+        next_rand() * 1000, next_rand() * 100, next_rand(), next_rand(),
+        next_rand() * 4096, next_rand() * 512);
+    if (write_file(dir, "io", buf, len) != 0) return -1;
+
+    len = snprintf(buf, sizeof(buf), "0::/system.slice/svc-%d.service\n", pid % 64);
+    return write_file(dir, "cgroup", buf, len);
+}
+
+// Parents tirés parmi les pids précédents, avec une préférence pour les premiers
+// (quelques démons avec beaucoup d'enfants, comme sur une vraie machine)
+static int build_tree(const char *root, int n) {
+    if (write_root_files(root) != 0) return -1;
+    for (int pid = 1; pid <= n; pid++) {
+        int ppid = 0;
+        if (pid > 1) {
+            int span = (next_rand() % 4 == 0) ? pid - 1 : (pid - 1 < 32 ? pid - 1 : 32);
+            ppid = 1 + (int)(((unsigned long)next_rand() << 15 | next_rand()) % span);
+        }
+        if (write_process(root, pid, ppid) != 0) return -1;
+    }
+    return 0;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int flag, struct FTW *ftw) {
+    (void)sb; (void)flag; (void)ftw;
+    return remove(path);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Affiche min / médiane / max d'une série de mesures (en secondes), triée sur place
+static void report(const char *label, double *samples, int n, int items) {
+    qsort(samples, n, sizeof(double), compare_double);
+    double med = samples[n / 2];
+    printf("  %-9s: min %8.2f ms  méd %8.2f ms  max %8.2f ms  %10.0f proc/s\n",
+           label, samples[0] * 1e3, med * 1e3, samples[n - 1] * 1e3,
+           med > 0 ? items / med : 0.0);
+}
+
+static void bench_size(int n) {
+    char root[] = "/tmp/my_htop_bench.XXXXXX";
+    if (!mkdtemp(root)) { perror("mkdtemp"); return; }
+
+    double t0 = now_sec();
+    if (build_tree(root, n) != 0) {
+        perror("génération du faux /proc");
+        nftw(root, remove_entry, 64, FTW_DEPTH | FTW_PHYS);
+        return;
+    }
+    printf("%d processus (faux /proc généré en %.2f s dans %s)\n", n, now_sec() - t0, root);
+
+    process_set_proc_root(root);
+    int iterations = 200000 / n;
+    if (iterations < 3) iterations = 3;
+    if (iterations > 50) iterations = 50;
+
+    ProcessInfo *procs = malloc(sizeof(ProcessInfo) * n);
+    ProcessInfo *copy = malloc(sizeof(ProcessInfo) * n);
+    double *samples = malloc(sizeof(double) * iterations);
+    if (!procs || !copy || !samples) { perror("malloc"); exit(EXIT_FAILURE); }
+
+    static PidTable table;
+    static SystemStats stats;
+    process_initial_scan(&table);
+    sysstats_update(&stats);
+    unsigned long long total = sysstats_cpu_total(&stats.total);
+
+    // Collecte paresseuse d'une page de 50 lignes (tri partiel puis champs
+    // différés), puis complète en pread et en io_uring. Le premier passage
+    // de chaque scénario ouvre les descripteurs, il n'est pas compté.
+    static const struct { const char *label; int flags; int uring; } runs[] = {
+        { "lazy 50", 0, 0 },
+        { "collect", COLLECT_FIELDS, 0 },
+        { "uring", COLLECT_FIELDS, 1 },
+    };
+    int count = 0;
+    for (int r = 0; r < 3; r++) {
+        if (runs[r].uring && !process_set_io_uring(1)) {
+            printf("  uring    : io_uring indisponible\n");
+            break;
+        }
+        count = process_collect_all(procs, n, total, &table, total + 400, runs[r].flags);
+        ProfCounters before = prof_counters;
+        for (int i = 0; i < iterations; i++) {
+            t0 = now_sec();
+            count = process_collect_all(procs, n, total, &table, total + 400, runs[r].flags);
+            if (!(runs[r].flags & COLLECT_FIELDS)) {
+                process_sort_top(procs, count, SORT_CPU, 50);
+                process_fill_rows(procs, count < 50 ? count : 50);
+            }
+            samples[i] = now_sec() - t0;
+        }
+        report(runs[r].label, samples, iterations, count);
+        char bytes_buf[32];
+        bytes_buf[fmt_size(bytes_buf, (prof_counters.bytes_read - before.bytes_read) / iterations)] = '\0';
+        printf("             par passe : %lu fichiers ouverts, %s lus, %lu appels système\n",
+               (prof_counters.files_opened - before.files_opened) / iterations, bytes_buf,
+               (prof_counters.syscalls - before.syscalls) / iterations);
+    }
+    process_set_io_uring(0);
+
+    // Tri : les fichiers ne changent pas entre deux passes, donc tous les CPU%
+    // seraient nuls ; on leur donne une répartition réaliste (beaucoup de zéros)
+    for (int i = 0; i < count; i++) {
+        procs[i].cpu_percent = (next_rand() % 3 == 0) ? (next_rand() % 10000) / 100.0 : 0.0;
+    }
+    static const struct { const char *label; SortMode mode; int top; } sorts[] = {
+        { "sort cpu", SORT_CPU, 0 }, { "sort mem", SORT_MEM, 0 }, { "top50 cpu", SORT_CPU, 50 },
+    };
+    for (int s = 0; s < 3; s++) {
+        for (int i = 0; i < iterations; i++) {
+            memcpy(copy, procs, sizeof(ProcessInfo) * count);
+            t0 = now_sec();
+            process_sort_top(copy, count, sorts[s].mode, sorts[s].top);
+            samples[i] = now_sec() - t0;
+        }
+        report(sorts[s].label, samples, iterations, count);
+    }
+
+    // Rendu de toutes les lignes (stdout n'est pas un terminal : pas de viewport)
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved_stdout >= 0 && devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        for (int i = 0; i < iterations; i++) {
+            t0 = now_sec();
+            ui_refresh_process_list(copy, count, 0);
+            samples[i] = now_sec() - t0;
+        }
+        fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        report("render", samples, iterations, count);
+    }
+    if (devnull >= 0) close(devnull);
+    if (saved_stdout >= 0) close(saved_stdout);
+
+    pidtable_free(&table);
+    sysstats_close();
+    free(procs);
+    free(copy);
+    free(samples);
+    nftw(root, remove_entry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+int main(int argc, char *argv[]) {
+    static const int defaults[] = { 1000, 10000, 100000 };
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            int n = atoi(argv[i]);
+            if (n > 0) bench_size(n);
+        }
+    } else {
+        for (int i = 0; i < 3; i++) bench_size(defaults[i]);
+    }
+    return EXIT_SUCCESS;
+}
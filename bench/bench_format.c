@@ -0,0 +1,126 @@
+// bench_format.c
+// Compare le rendu d'une ligne de processus : ancien chemin printf/snprintf
+// (format_size en flottant + printf à 12 conversions) contre la couche fmt
+// (conversion par table, virgule fixe, colonnes pré-remplies dans un LineBuf).
+// Usage : bench_format [nombre_de_lignes]   (100000 par défaut)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ui.h"
+
+// --- ancien chemin, recopié tel quel avant la couche fmt ---
+static void legacy_format_size(unsigned long bytes, char *buf, size_t buf_size) {
+    if (bytes >= 1024UL * 1024UL * 1024UL) {
+        snprintf(buf, buf_size, "%.1fG", bytes / (1024.0 * 1024.0 * 1024.0));
+    } else if (bytes >= 1024UL * 1024UL) {
+        snprintf(buf, buf_size, "%.1fM", bytes / (1024.0 * 1024.0));
+    } else if (bytes >= 1024UL) {
+        snprintf(buf, buf_size, "%.1fK", bytes / 1024.0);
+    } else {
+        snprintf(buf, buf_size, "%luB", bytes);
+    }
+}
+
+static int legacy_format_process(char *out, size_t size, const ProcessInfo *info) {
+    char virt_buf[16], res_buf[16], shr_buf[16];
+    legacy_format_size(info->virt, virt_buf, sizeof(virt_buf));
+    legacy_format_size(info->res,  res_buf, sizeof(res_buf));
+    legacy_format_size(info->shr,  shr_buf, sizeof(shr_buf));
+    return snprintf(out, size, "%-6d %-17s %-4ld %-4ld %-10s %-10s %-10s %-3c %-6.2f %-6.2f %-10lu %s\n",
+                    info->pid, process_user(info),
+                    info->priority, info->nice,
+                    virt_buf, res_buf, shr_buf,
+                    info->state, info->mem_percent,
+                    info->cpu_percent,
+                    info->time, process_cmdline(info));
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Lignes synthétiques aux valeurs réalistes (tailles de l'octet au Go)
+static void fill_rows(ProcessInfo *rows, int n) {
+    static const char *users[] = { "root", "postgres", "www-data", "app", "systemd-network" };
+    static const char *names[] = { "java", "postgres", "nginx", "python3", "kworker/3:1-events" };
+    static const char *args[] = { "/usr/bin/java -Xmx2g -jar /opt/app/app.jar", "postgres: checkpointer",
+                                  "nginx: worker process", "/usr/bin/python3 -m http.server 8080",
+                                  "kworker/3:1-events" };
+    srand(42);
+    for (int i = 0; i < n; i++) {
+        ProcessInfo *p = &rows[i];
+        memset(p, 0, sizeof(*p));
+        p->pid = 1 + rand() % 4194304;
+        const char *user = users[rand() % 5];
+        int cmd = rand() % 5;
+        p->user_id = strpool_intern(user, strlen(user));
+        p->name_id = strpool_intern(names[cmd], strlen(names[cmd]));
+        p->cmd_id = strpool_intern(args[cmd], strlen(args[cmd]));
+        p->state = "RSDIZ"[rand() % 5];
+        p->priority = 20 - rand() % 40;
+        p->nice = rand() % 40 - 20;
+        p->virt = ((unsigned long)rand() << 12) ^ rand();
+        p->res = p->virt >> (rand() % 8);
+        p->shr = p->res >> (rand() % 4);
+        p->mem_percent = (rand() % 10000) / 100.0;
+        p->cpu_percent = (rand() % 40000) / 100.0;
+        p->time = rand();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 100000;
+    if (n <= 0) n = 100000;
+    ProcessInfo *rows = malloc(sizeof(ProcessInfo) * n);
+    if (!rows) return EXIT_FAILURE;
+    fill_rows(rows, n);
+
+    FILE *devnull = fopen("/dev/null", "w");
+    if (!devnull) return EXIT_FAILURE;
+    char line[LINEBUF_SIZE];
+    LineBuf lb;
+
+    // chemin printf
+    size_t legacy_bytes = 0;
+    double t0 = now_sec();
+    for (int i = 0; i < n; i++) {
+        int len = legacy_format_process(line, sizeof(line), &rows[i]);
+        fwrite(line, 1, len, devnull);
+        legacy_bytes += len;
+    }
+    double legacy = now_sec() - t0;
+
+    // couche fmt
+    size_t fmt_bytes = 0;
+    t0 = now_sec();
+    for (int i = 0; i < n; i++) {
+        ui_format_process(&lb, &rows[i], 0, "");
+        fwrite(lb.data, 1, lb.len, devnull);
+        fmt_bytes += lb.len;
+    }
+    double fast = now_sec() - t0;
+
+    // Vérification : les deux chemins doivent produire le même texte
+    // (hors égalités d'arrondi à la demi-unité, que printf traite autrement)
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) {
+        legacy_format_process(line, sizeof(line), &rows[i]);
+        ui_format_process(&lb, &rows[i], 0, "");
+        if (strcmp(line, lb.data) != 0) {
+            if (mismatches == 0) printf("premier écart :\n  printf: %s  fmt:    %s", line, lb.data);
+            mismatches++;
+        }
+    }
+
+    printf("%d lignes\n", n);
+    printf("  printf : %8.2f ms  %6.0f ns/ligne  %zu octets\n", legacy * 1e3, legacy * 1e9 / n, legacy_bytes);
+    printf("  fmt    : %8.2f ms  %6.0f ns/ligne  %zu octets\n", fast * 1e3, fast * 1e9 / n, fmt_bytes);
+    printf("  gain   : x%.1f, %d ligne(s) différente(s)\n", fast > 0 ? legacy / fast : 0.0, mismatches);
+
+    fclose(devnull);
+    free(rows);
+    return EXIT_SUCCESS;
+}
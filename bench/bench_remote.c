@@ -0,0 +1,80 @@
+// bench_remote.c
+// Chemin distant sans serveur SSH : network_collect() est lié au stand-in
+// libssh de bench/sshstub, qui rejoue une sortie de ps synthétique avec un
+// délai aller-retour configurable. Mesure, pour 1, 10 et 100 hôtes simulés
+// interrogés l'un après l'autre, la latence d'une trame complète, les octets
+// transférés et le temps passé dans chaque phase de network_collect().
+// Usage : bench_remote [lignes_par_hôte] [latence_ms] [trames]   (500 1 10 par défaut)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "network.h"
+#include "profile.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_hosts(int hosts, int rows, int latency_ms, int frames) {
+    ssh_session *sessions = malloc(sizeof(ssh_session) * hosts);
+    ProcessInfo *procs = malloc(sizeof(ProcessInfo) * (rows + 1));
+    double *samples = malloc(sizeof(double) * frames);
+    if (!sessions || !procs || !samples) { perror("malloc"); exit(EXIT_FAILURE); }
+    for (int h = 0; h < hosts; h++) {
+        sessions[h] = sshstub_session_new(rows, latency_ms * 1000, 0);
+        if (!sessions[h]) { perror("sshstub_session_new"); exit(EXIT_FAILURE); }
+    }
+
+    double phase_ms[PROF_NPHASES] = {0};
+    unsigned long bytes = 0;
+    long parsed = 0;
+    for (int f = 0; f < frames; f++) {
+        prof_frame_begin("bench");
+        double t0 = now_sec();
+        for (int h = 0; h < hosts; h++) {
+            parsed += network_collect(sessions[h], procs, rows + 1);
+        }
+        samples[f] = now_sec() - t0;
+        prof_frame_end();
+        const ProfReport *r = prof_last_frame();
+        for (int i = 0; i < PROF_NPHASES; i++) phase_ms[i] += r->phase_ms[i];
+        bytes += r->counters.bytes_read;
+    }
+
+    qsort(samples, frames, sizeof(double), compare_double);
+    printf("%3d hôte(s) x %d lignes, latence %d ms\n", hosts, rows, latency_ms);
+    printf("  trame   : min %8.2f ms  méd %8.2f ms  max %8.2f ms\n",
+           samples[0] * 1e3, samples[frames / 2] * 1e3, samples[frames - 1] * 1e3);
+    printf("  par trame : %lu octets reçus, %ld lignes analysées sur %d envoyées\n",
+           bytes / frames, parsed / frames, hosts * rows);
+    printf("  par trame : exec %.2f ms  lecture %.2f ms  analyse %.2f ms (%.0f ns/ligne)\n",
+           phase_ms[PROF_NET_EXEC] / frames, phase_ms[PROF_NET_READ] / frames,
+           phase_ms[PROF_NET_PARSE] / frames,
+           parsed > 0 ? phase_ms[PROF_NET_PARSE] * 1e6 / parsed : 0.0);
+
+    for (int h = 0; h < hosts; h++) ssh_free(sessions[h]);
+    free(sessions);
+    free(procs);
+    free(samples);
+}
+
+int main(int argc, char *argv[]) {
+    int rows = (argc > 1) ? atoi(argv[1]) : 500;
+    int latency_ms = (argc > 2) ? atoi(argv[2]) : 1;
+    int frames = (argc > 3) ? atoi(argv[3]) : 10;
+    if (rows <= 0) rows = 500;
+    if (latency_ms < 0) latency_ms = 0;
+    if (frames <= 0) frames = 10;
+
+    static const int host_counts[] = { 1, 10, 100 };
+    for (int i = 0; i < 3; i++) bench_hosts(host_counts[i], rows, latency_ms, frames);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+// libssh.h (stand-in pour les benchmarks)
+// Sous-ensemble de l'API libssh utilisé par src/network.c, mêmes signatures.
+// Les sessions ne se connectent à rien : elles rejouent une sortie de ps
+// synthétique (voir sshstub.c), ce qui rend le chemin distant mesurable
+// sans serveur SSH.
+#ifndef BENCH_SSHSTUB_LIBSSH_H
+#define BENCH_SSHSTUB_LIBSSH_H
+
+#include <stdint.h>
+
+typedef struct ssh_session_struct *ssh_session;
+typedef struct ssh_channel_struct *ssh_channel;
+
+enum { SSH_OK = 0, SSH_ERROR = -1, SSH_AGAIN = -2, SSH_EOF = -127 };
+enum { SSH_AUTH_SUCCESS = 0, SSH_AUTH_DENIED = 1 };
+enum ssh_options_e { SSH_OPTIONS_HOST, SSH_OPTIONS_PORT, SSH_OPTIONS_USER };
+
+ssh_session ssh_new(void);
+void ssh_free(ssh_session session);
+int ssh_options_set(ssh_session session, enum ssh_options_e type, const void *value);
+int ssh_connect(ssh_session session);
+void ssh_disconnect(ssh_session session);
+const char *ssh_get_error(void *error);
+int ssh_userauth_password(ssh_session session, const char *username, const char *password);
+
+ssh_channel ssh_channel_new(ssh_session session);
+int ssh_channel_open_session(ssh_channel channel);
+int ssh_channel_request_exec(ssh_channel channel, const char *cmd);
+int ssh_channel_read(ssh_channel channel, void *dest, uint32_t count, int is_stderr);
+int ssh_channel_send_eof(ssh_channel channel);
+int ssh_channel_close(ssh_channel channel);
+void ssh_channel_free(ssh_channel channel);
+
+// --- propre au stand-in ---
+
+// Session rejouant 'rows' lignes de ps, avec 'latency_us' de délai aller-retour
+// à l'exécution de la commande et des paquets de 'packet' octets au plus
+ssh_session sshstub_session_new(int rows, int latency_us, int packet);
+// Octets envoyés par la session depuis sa création
+unsigned long sshstub_bytes_sent(ssh_session session);
+
+#endif
@@ -0,0 +1,153 @@
+// sshstub.c
+// Implémentation du stand-in libssh des benchmarks : chaque session garde une
+// sortie de ps synthétique, au format de la commande de network_collect()
+// (pid,user,state,pri,ni,vsz,rss,pmem,pcpu,times,psr,comm:15,args), et la renvoie à chaque
+// ssh_channel_request_exec() après le délai configuré.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <libssh/libssh.h>
+
+struct ssh_session_struct {
+    char *output;         // sortie de ps rejouée
+    size_t output_len;
+    int latency_us;
+    int packet;
+    unsigned long bytes_sent;
+    int connected;
+};
+
+struct ssh_channel_struct {
+    ssh_session session;
+    size_t pos;           // position dans la sortie
+    int executing;
+};
+
+static unsigned int seed = 7;
+static unsigned int next_rand(void) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+static char *make_ps_output(int rows, size_t *len_out) {
+    static const char *users[] = { "root", "postgres", "www-data", "nobody", "app" };
+    static const char *names[] = { "java", "postgres", "nginx", "python3", "kworker/3:1-events", "sshd" };
+    static const char *args[] = { "/usr/bin/java -Xmx2g -jar /opt/app/app.jar --spring.profiles.active=prod",
+                                  "postgres: app appdb 10.0.0.12(51234) idle", "nginx: worker process",
+                                  "/usr/bin/python3 -m gunicorn app:wsgi -w 4", "[kworker/3:1-events]",
+                                  "sshd: app [priv]" };
+    size_t cap = 128 + (size_t)rows * 256;
+    char *out = malloc(cap);
+    if (!out) return NULL;
+    size_t len = snprintf(out, cap, "  PID USER     S PRI  NI    VSZ   RSS %%MEM %%CPU     TIME PSR COMMAND         COMMAND\n");
+    for (int i = 0; i < rows && len < cap; i++) {
+        unsigned long vsz = (unsigned long)(next_rand() + 1) * 64;
+        int cmd = next_rand() % 6;
+        len += snprintf(out + len, cap - len, "%5d %-8s %c %3d %3d %6lu %5lu %4.1f %4.1f %8u %3u %-15.15s %s\n",
+                        i + 1, users[next_rand() % 5], "SSRDI"[next_rand() % 5],
+                        19, 0, vsz, vsz >> (next_rand() % 6),
+                        (next_rand() % 1000) / 10.0, (next_rand() % 2000) / 10.0,
+                        next_rand(), next_rand() % 64, names[cmd], args[cmd]);
+    }
+    *len_out = len < cap ? len : cap - 1;
+    return out;
+}
+
+ssh_session sshstub_session_new(int rows, int latency_us, int packet) {
+    ssh_session s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->output = make_ps_output(rows, &s->output_len);
+    if (!s->output) { free(s); return NULL; }
+    s->latency_us = latency_us;
+    s->packet = packet > 0 ? packet : 16384;
+    s->connected = 1;
+    return s;
+}
+
+unsigned long sshstub_bytes_sent(ssh_session session) {
+    return session->bytes_sent;
+}
+
+ssh_session ssh_new(void) {
+    return sshstub_session_new(0, 0, 0);
+}
+
+void ssh_free(ssh_session session) {
+    if (!session) return;
+    free(session->output);
+    free(session);
+}
+
+int ssh_options_set(ssh_session session, enum ssh_options_e type, const void *value) {
+    (void)session; (void)type; (void)value;
+    return SSH_OK;
+}
+
+int ssh_connect(ssh_session session) {
+    session->connected = 1;
+    return SSH_OK;
+}
+
+void ssh_disconnect(ssh_session session) {
+    session->connected = 0;
+}
+
+const char *ssh_get_error(void *error) {
+    (void)error;
+    return "sshstub";
+}
+
+int ssh_userauth_password(ssh_session session, const char *username, const char *password) {
+    (void)session; (void)username; (void)password;
+    return SSH_AUTH_SUCCESS;
+}
+
+ssh_channel ssh_channel_new(ssh_session session) {
+    if (!session || !session->connected) return NULL;
+    ssh_channel c = calloc(1, sizeof(*c));
+    if (c) c->session = session;
+    return c;
+}
+
+int ssh_channel_open_session(ssh_channel channel) {
+    (void)channel;
+    return SSH_OK;
+}
+
+int ssh_channel_request_exec(ssh_channel channel, const char *cmd) {
+    (void)cmd; // la commande (et le filtre awk) n'est pas interprétée
+    if (channel->session->latency_us > 0) {
+        int us = channel->session->latency_us;
+        nanosleep(&(struct timespec){ us / 1000000, (us % 1000000) * 1000L }, NULL);
+    }
+    channel->pos = 0;
+    channel->executing = 1;
+    return SSH_OK;
+}
+
+int ssh_channel_read(ssh_channel channel, void *dest, uint32_t count, int is_stderr) {
+    ssh_session s = channel->session;
+    if (is_stderr || !channel->executing || channel->pos >= s->output_len) return 0;
+    size_t n = s->output_len - channel->pos;
+    if (n > count) n = count;
+    if (n > (size_t)s->packet) n = s->packet;
+    memcpy(dest, s->output + channel->pos, n);
+    channel->pos += n;
+    s->bytes_sent += n;
+    return (int)n;
+}
+
+int ssh_channel_send_eof(ssh_channel channel) {
+    (void)channel;
+    return SSH_OK;
+}
+
+int ssh_channel_close(ssh_channel channel) {
+    channel->executing = 0;
+    return SSH_OK;
+}
+
+void ssh_channel_free(ssh_channel channel) {
+    free(channel);
+}
@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "alert.h"
+#include "refresh.h"
+
+static AlertRule rules[ALERT_MAX_RULES];
+static int nrules = 0;
+
+static FILE *log_file = NULL;
+static AlertSignalFn send_signal = NULL;
+
+static char last_event[ALERT_EVENT_LEN];
+static unsigned long event_count = 0;
+
+// Commandes de hook en cours (récoltées à chaque évaluation)
+static pid_t hooks[ALERT_MAX_HOOKS];
+static int nhooks = 0;
+
+// ----------- compilation des règles -----------------
+
+static const struct { const char *name; int sig; } signal_actions[] = {
+    { "kill", SIGTERM }, { "pause", SIGSTOP }, { "resume", SIGCONT }, { "restart", SIGHUP },
+};
+#define NSIGNAL_ACTIONS ((int)(sizeof(signal_actions) / sizeof(signal_actions[0])))
+
+// Copie le mot suivant dans tok. Retourne la position après le mot, ou NULL en fin de ligne.
+static const char *next_token(const char *p, char *tok, size_t size) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    if (!*p) return NULL;
+    size_t n = 0;
+    while (*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+        if (n + 1 < size) tok[n++] = *p;
+        p++;
+    }
+    tok[n] = '\0';
+    return p;
+}
+
+// "30", "30s", "500ms", "2m", "1h" -> secondes
+static int parse_duration(const char *v, double *out) {
+    char *end;
+    double n = strtod(v, &end);
+    if (end == v || n < 0) return -1;
+    if (strcmp(end, "ms") == 0) n /= 1000.0;
+    else if (strcmp(end, "m") == 0) n *= 60.0;
+    else if (strcmp(end, "h") == 0) n *= 3600.0;
+    else if (*end != '\0' && strcmp(end, "s") != 0) return -1;
+    *out = n;
+    return 0;
+}
+
+int alert_add_rule(const char *text, char *err, size_t err_size) {
+    if (nrules >= ALERT_MAX_RULES) {
+        snprintf(err, err_size, "trop de règles (max %d)", ALERT_MAX_RULES);
+        return -1;
+    }
+    if (strlen(text) >= ALERT_RULE_LEN) {
+        snprintf(err, err_size, "règle trop longue");
+        return -1;
+    }
+
+    AlertRule r;
+    memset(&r, 0, sizeof(r));
+    r.action = ALERT_LOG;
+    char cond[MAX_FILTER_LEN] = "";
+    char tok[MAX_NAME_LEN + 1];     // un nom d'hôte plus long est refusé, pas tronqué
+    const char *p = text;
+    while ((p = next_token(p, tok, sizeof(tok))) != NULL) {
+        if (strcmp(tok, "for") == 0) {
+            if (!(p = next_token(p, tok, sizeof(tok))) || parse_duration(tok, &r.duration) != 0) {
+                snprintf(err, err_size, "durée invalide après 'for' (ex: 30s, 2m)");
+                return -1;
+            }
+        } else if (strcmp(tok, "on") == 0) {
+            if (!(p = next_token(p, tok, sizeof(tok)))) {
+                snprintf(err, err_size, "hôte manquant après 'on'");
+                return -1;
+            }
+            size_t len = strlen(tok);
+            if (len >= sizeof(r.host)) {
+                snprintf(err, err_size, "nom d'hôte trop long après 'on' (max %d)", MAX_NAME_LEN - 1);
+                return -1;
+            }
+            if (strcmp(tok, "any") != 0) memcpy(r.host, tok, len + 1);
+        } else if (strcmp(tok, "do") == 0) {
+            if (!(p = next_token(p, tok, sizeof(tok)))) {
+                snprintf(err, err_size, "action manquante après 'do'");
+                return -1;
+            }
+            int si = -1;
+            for (int i = 0; i < NSIGNAL_ACTIONS; i++) {
+                if (strcmp(tok, signal_actions[i].name) == 0) si = i;
+            }
+            if (strcmp(tok, "log") == 0) {
+                r.action = ALERT_LOG;
+            } else if (strcmp(tok, "hook") == 0) {
+                // la commande est le reste de la ligne
+                while (*p == ' ' || *p == '\t') p++;
+                size_t len = strcspn(p, "\r\n");
+                if (len == 0 || len >= sizeof(r.hook)) {
+                    snprintf(err, err_size, "commande de hook absente ou trop longue");
+                    return -1;
+                }
+                memcpy(r.hook, p, len);
+                r.hook[len] = '\0';
+                r.action = ALERT_HOOK;
+                break;
+            } else if (si >= 0) {
+                r.action = ALERT_SIGNAL;
+                r.signal = signal_actions[si].sig;
+            } else {
+                snprintf(err, err_size, "action inconnue '%s' (log, hook, kill, pause, resume, restart)", tok);
+                return -1;
+            }
+        } else {
+            size_t len = strlen(cond);
+            if (len + strlen(tok) + 2 > sizeof(cond)) {
+                snprintf(err, err_size, "condition trop longue");
+                return -1;
+            }
+            if (len) cond[len++] = ' ';
+            memcpy(cond + len, tok, strlen(tok) + 1);
+        }
+    }
+    if (cond[0] == '\0') {
+        snprintf(err, err_size, "règle sans condition");
+        return -1;
+    }
+    if (filter_compile(cond, &r.cond, err, err_size) != 0) return -1;
+
+    snprintf(r.text, sizeof(r.text), "%s", text);
+    r.text[strcspn(r.text, "\r\n")] = '\0';
+    rules[nrules++] = r;
+    return 0;
+}
+
+int alert_load_file(const char *path, char *err, size_t err_size) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        snprintf(err, err_size, "%s : %s", path, strerror(errno));
+        return -1;
+    }
+    char line[ALERT_RULE_LEN], msg[160];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        const char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+        if (alert_add_rule(p, msg, sizeof(msg)) != 0) {
+            snprintf(err, err_size, "%s:%d : %s", path, lineno, msg);
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int alert_rule_count(void) {
+    return nrules;
+}
+
+const AlertRule *alert_rule(int i) {
+    return (i >= 0 && i < nrules) ? &rules[i] : NULL;
+}
+
+int alert_collect_flags(void) {
+    int flags = 0;
+    for (int i = 0; i < nrules; i++) {
+        if (rules[i].cond.stage_count[FILTER_STAGE_STATM]) flags |= COLLECT_MEM;
+        if (rules[i].cond.stage_count[FILTER_STAGE_USER]) flags |= COLLECT_USER;
+    }
+    return flags;
+}
+
+void alert_set_log(FILE *f) {
+    log_file = f;
+}
+
+void alert_set_signal_handler(AlertSignalFn fn) {
+    send_signal = fn;
+}
+
+const char *alert_last_event(void) {
+    return last_event;
+}
+
+unsigned long alert_event_count(void) {
+    return event_count;
+}
+
+// ----------- état par (source, pid, règle) -----------------
+
+// Une entrée n'existe que tant que la condition est vraie : elle est touchée
+// à chaque instantané de sa source (epoch), et une entrée qui a manqué un
+// instantané (condition fausse ou pid disparu) repart de zéro. Les entrées
+// mortes ne sont pas supprimées une à une : elles disparaissent quand la
+// table est reconstruite, au moment où elle devrait grandir.
+typedef struct {
+    int pid;              // 0 : entrée libre
+    int source;
+    int rule;
+    int fired;            // action déjà exécutée pour cet épisode
+    unsigned int epoch;   // dernier instantané de la source où la condition était vraie
+    double since;         // horodatage monotone du début de l'épisode
+} AlertState;
+
+static AlertState *states = NULL;
+static int state_cap = 0;      // puissance de 2
+static int state_used = 0;
+static unsigned int source_epoch[ALERT_MAX_SOURCES];
+
+static unsigned int state_hash(int source, int pid, int rule) {
+    unsigned int h = (unsigned int)pid * 2654435761u;
+    h ^= (unsigned int)(rule + 1) * 40503u;
+    h ^= (unsigned int)(source + 1) * 2246822519u;
+    return h ^ (h >> 15);
+}
+
+static int state_alive(const AlertState *s) {
+    return source_epoch[s->source + 1] - s->epoch <= 1;
+}
+
+static AlertState *state_slot(AlertState *table, int cap, int source, int pid, int rule) {
+    unsigned int mask = cap - 1;
+    unsigned int i = state_hash(source, pid, rule) & mask;
+    while (table[i].pid != 0 &&
+           (table[i].pid != pid || table[i].source != source || table[i].rule != rule)) {
+        i = (i + 1) & mask;
+    }
+    return &table[i];
+}
+
+// Reconstruit la table en ne gardant que les entrées vivantes
+static int state_rebuild(void) {
+    int live = 0;
+    for (int i = 0; i < state_cap; i++) {
+        if (states[i].pid != 0 && state_alive(&states[i])) live++;
+    }
+    int cap = state_cap ? state_cap : 1024;
+    while ((live + 1) * 4 > cap) cap *= 2; // au plus 1/4 plein : pas de reconstruction à chaque insertion
+    AlertState *table = calloc(cap, sizeof(AlertState));
+    if (!table) return -1;
+    for (int i = 0; i < state_cap; i++) {
+        AlertState *s = &states[i];
+        if (s->pid != 0 && state_alive(s)) *state_slot(table, cap, s->source, s->pid, s->rule) = *s;
+    }
+    free(states);
+    states = table;
+    state_cap = cap;
+    state_used = live;
+    return 0;
+}
+
+// Entrée de (source, pid, règle), créée si besoin (*created = 1). NULL si plus de mémoire.
+static AlertState *state_get(int source, int pid, int rule, int *created) {
+    *created = 0;
+    if (state_cap > 0) {
+        AlertState *s = state_slot(states, state_cap, source, pid, rule);
+        if (s->pid != 0) return s;
+    }
+    if ((state_used + 1) * 2 > state_cap && state_rebuild() != 0) return NULL;
+    AlertState *s = state_slot(states, state_cap, source, pid, rule);
+    s->pid = pid;
+    s->source = source;
+    s->rule = rule;
+    state_used++;
+    *created = 1;
+    return s;
+}
+
+// ----------- actions -----------------
+
+static void reap_hooks(void) {
+    for (int i = 0; i < nhooks; ) {
+        if (waitpid(hooks[i], NULL, WNOHANG) != 0) hooks[i] = hooks[--nhooks]; // terminé (ou perdu)
+        else i++;
+    }
+}
+
+// /bin/sh -c <hook>, sans terminal (l'interface occupe l'écran), avec le
+// contexte du déclenchement dans l'environnement
+static int run_hook(const AlertRule *r, const char *source_name, const ProcessInfo *info) {
+    if (nhooks >= ALERT_MAX_HOOKS) return -1;
+    pid_t child = fork();
+    if (child < 0) return -1;
+    if (child == 0) {
+        char num[32];
+        setenv("MY_HTOP_RULE", r->text, 1);
+        setenv("MY_HTOP_HOST", source_name, 1);
+        snprintf(num, sizeof(num), "%d", info->pid);
+        setenv("MY_HTOP_PID", num, 1);
+        setenv("MY_HTOP_NAME", process_name(info), 1);
+        setenv("MY_HTOP_USER", process_user(info), 1);
+        setenv("MY_HTOP_CMDLINE", process_cmdline(info), 1);
+        snprintf(num, sizeof(num), "%.2f", info->cpu_percent);
+        setenv("MY_HTOP_CPU", num, 1);
+        snprintf(num, sizeof(num), "%lu", info->res);
+        setenv("MY_HTOP_RSS", num, 1);
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+        execl("/bin/sh", "sh", "-c", r->hook, (char *)NULL);
+        _exit(127);
+    }
+    hooks[nhooks++] = child;
+    return 0;
+}
+
+static void fire(const AlertRule *r, int source, const char *source_name, const ProcessInfo *info) {
+    const char *outcome = "";
+    if (r->action == ALERT_HOOK) {
+        outcome = (run_hook(r, source_name, info) == 0) ? "hook lancé" : "hook ignoré (trop de hooks en cours)";
+    } else if (r->action == ALERT_SIGNAL) {
+        if (source < 0 && info->pid == getpid()) outcome = "signal ignoré (moniteur)";
+        else if (!send_signal) outcome = "signal non envoyé (pas de session)";
+        else outcome = (send_signal(source, info->pid, r->signal) == 0) ? "signal envoyé" : "échec du signal";
+    }
+
+    char stamp[16];
+    time_t t = time(NULL);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", &tm);
+    // la règle est coupée pour laisser la place au résultat de l'action
+    snprintf(last_event, sizeof(last_event), "%s %s pid %d (%s) : %.*s%s%s",
+             stamp, source_name, info->pid, process_name(info), ALERT_EVENT_LEN / 2, r->text,
+             outcome[0] ? " -> " : "", outcome);
+    event_count++;
+    if (log_file) {
+        fprintf(log_file, "%s\n", last_event);
+        fflush(log_file);
+    }
+}
+
+// ----------- évaluation -----------------
+
+static int rule_applies(const AlertRule *r, int source, const char *name) {
+    if (r->host[0] == '\0') return 1;
+    if (strcmp(r->host, "local") == 0) return source < 0;
+    return source >= 0 && strcmp(r->host, name) == 0;
+}
+
+int alert_evaluate(int source, const char *name, ProcessInfo rows[], int count) {
+    for (int i = 0; i < count; i++) rows[i].alert = ALERT_NONE;
+    if (nrules == 0 || source + 1 < 0 || source + 1 >= ALERT_MAX_SOURCES) return 0;
+    reap_hooks();
+
+    // règles de cette source, une fois pour tout l'instantané
+    static int active[ALERT_MAX_RULES];
+    int nactive = 0;
+    for (int r = 0; r < nrules; r++) {
+        if (rule_applies(&rules[r], source, name)) active[nactive++] = r;
+    }
+    if (nactive == 0) return 0;
+
+    unsigned int epoch = ++source_epoch[source + 1];
+    double now = refresh_now();
+    int fired = 0;
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *info = &rows[i];
+        if (info->pid <= 0) continue;
+        for (int k = 0; k < nactive; k++) {
+            const AlertRule *r = &rules[active[k]];
+            if (!filter_match_all(&r->cond, info)) continue;
+            int created;
+            AlertState *s = state_get(source, info->pid, active[k], &created);
+            if (!s) continue;
+            if (created || epoch - s->epoch > 1) { // nouvel épisode
+                s->since = now;
+                s->fired = 0;
+            }
+            s->epoch = epoch;
+
+            int level = ALERT_PENDING;
+            if (now - s->since >= r->duration) {
+                level = ALERT_FIRING;
+                if (!s->fired) {
+                    s->fired = 1;
+                    fire(r, source, name, info);
+                    fired++;
+                }
+            }
+            if (level > info->alert) info->alert = level;
+        }
+    }
+    return fired;
+}
+
+void alert_reset_source(int source) {
+    if (source + 1 < 0 || source + 1 >= ALERT_MAX_SOURCES) return;
+    // deux instantanés d'écart : toutes les entrées de la source sont mortes
+    source_epoch[source + 1] += 2;
+}
@@ -0,0 +1,83 @@
+#ifndef ALERT_H
+#define ALERT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "manager.h"
+#include "process.h"
+#include "filter.h"
+
+// Règles d'alerte évaluées sur chaque instantané (local, hôtes distants, démon).
+// Une règle est une ligne :
+//
+//   <condition> [for <durée>] [on any|local|<hôte>] [do log|hook <commande>|kill|pause|resume|restart]
+//
+//   cpu>90 for 30s
+//   rss>8G user=app for 1m on local do hook /usr/local/bin/page.sh
+//   name~leaky rss>2G for 10s on web1 do restart
+//
+// La condition a la syntaxe de --filter (conjonction de termes). La règle se
+// déclenche une fois quand la condition tient depuis la durée demandée pour un
+// même pid, puis se réarme dès qu'elle cesse d'être vraie. L'état est gardé
+// par (source, pid, règle) et mis à jour à chaque instantané, sans historique
+// à reparcourir : seules les conditions vraies occupent une entrée.
+
+#define ALERT_MAX_RULES 256
+#define ALERT_RULE_LEN 512
+#define ALERT_HOOK_LEN 256
+#define ALERT_MAX_HOOKS 8           // commandes lancées en même temps, au-delà : ignorées
+#define ALERT_MAX_SOURCES (MAX_HOSTS + 1)
+#define ALERT_EVENT_LEN 256
+
+// Valeurs de ProcessInfo.alert, posées par alert_evaluate()
+#define ALERT_NONE 0
+#define ALERT_PENDING 1             // condition vraie, durée pas encore atteinte
+#define ALERT_FIRING 2              // condition vraie depuis au moins la durée
+
+typedef enum {
+    ALERT_LOG,      // journal et barre d'état seulement
+    ALERT_HOOK,     // /bin/sh -c <commande>, variables MY_HTOP_* dans l'environnement
+    ALERT_SIGNAL    // signal envoyé au processus (kill, pause, resume, restart)
+} AlertAction;
+
+typedef struct {
+    Filter cond;
+    double duration;                // secondes
+    char host[MAX_NAME_LEN];        // "" : toutes les sources, "local", ou display_name d'un hôte
+    AlertAction action;
+    int signal;                     // ALERT_SIGNAL
+    char hook[ALERT_HOOK_LEN];      // ALERT_HOOK
+    char text[ALERT_RULE_LEN];      // ligne d'origine, pour le journal
+} AlertRule;
+
+// Envoi d'un signal pour une règle : source -1 = local, sinon index d'hôte.
+// Retourne 0 si envoyé.
+typedef int (*AlertSignalFn)(int source, int pid, int sig);
+
+// Ajoute une règle. Retourne 0, ou -1 avec un message dans err.
+int alert_add_rule(const char *text, char *err, size_t err_size);
+// Une règle par ligne, lignes vides et commentaires '#' ignorés.
+// Retourne 0, ou -1 avec un message (préfixé du numéro de ligne) dans err.
+int alert_load_file(const char *path, char *err, size_t err_size);
+int alert_rule_count(void);
+const AlertRule *alert_rule(int i);
+
+// Champs différés (COLLECT_MEM, COLLECT_USER) testés par les règles : la
+// collecte locale doit les lire pour tous les pids
+int alert_collect_flags(void);
+
+void alert_set_log(FILE *f);                  // NULL : pas de journal
+void alert_set_signal_handler(AlertSignalFn fn);
+
+// Évalue les règles de la source sur un instantané complet et pose
+// rows[i].alert. source : -1 local, sinon index d'hôte ; name : nom affiché
+// (comparé au "on <hôte>" des règles). Retourne le nombre de déclenchements.
+int alert_evaluate(int source, const char *name, ProcessInfo rows[], int count);
+// Oublie les épisodes en cours d'une source (hôte retiré ou remplacé à cet index)
+void alert_reset_source(int source);
+
+// Dernier déclenchement ("" si aucun) et nombre total depuis le lancement
+const char *alert_last_event(void);
+unsigned long alert_event_count(void);
+
+#endif
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "cgroup.h"
+#include "strpool.h"
+
+#define CGROUP_ACC_SIZE (MAX_CGROUPS * 2) // puissance de 2, charge max 1/2
+#define CGROUP_V2_ROOT "/sys/fs/cgroup"
+
+// Accumulateurs par cgroup (clé : identifiant du chemin dans le pool de
+// chaînes), remis à zéro paresseusement grâce à l'epoch. Les cgroups
+// disparus sont purgés quand la table se remplit : seuls MAX_CGROUPS
+// cgroups actifs en même temps comptent, pas tous ceux vus depuis le lancement.
+typedef struct {
+    int id;                             // 0 : entrée libre
+    unsigned int epoch;                 // dernière agrégation où le cgroup avait des processus
+    CgroupStats stats;
+    unsigned long long prev_usage_usec; // cpu.stat usage_usec précédent
+    double prev_time;
+} CgroupAcc;
+
+static CgroupAcc acc[CGROUP_ACC_SIZE];
+static int acc_used = 0;
+static unsigned int acc_epoch = 0;
+
+static unsigned int hash_id(int id) {
+    unsigned int h = (unsigned int)id * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+static CgroupAcc *acc_find(int id) {
+    unsigned int i = hash_id(id) & (CGROUP_ACC_SIZE - 1);
+    while (acc[i].id != 0) {
+        if (acc[i].id == id) return &acc[i];
+        i = (i + 1) & (CGROUP_ACC_SIZE - 1);
+    }
+    return NULL;
+}
+
+// Garde les cgroups vus depuis au plus max_age agrégations (à 1, ceux de la
+// précédente gardent leur delta de cpu.stat) et dont le chemin est encore dans le pool
+static void acc_purge(unsigned int max_age) {
+    static CgroupAcc kept[MAX_CGROUPS];
+    int n = 0;
+    for (int i = 0; i < CGROUP_ACC_SIZE; i++) {
+        if (acc[i].id != 0 && acc_epoch - acc[i].epoch <= max_age && strpool_valid(acc[i].id)) kept[n++] = acc[i];
+    }
+    memset(acc, 0, sizeof(acc));
+    for (int k = 0; k < n; k++) {
+        unsigned int i = hash_id(kept[k].id) & (CGROUP_ACC_SIZE - 1);
+        while (acc[i].id != 0) i = (i + 1) & (CGROUP_ACC_SIZE - 1);
+        acc[i] = kept[k];
+    }
+    acc_used = n;
+}
+
+// Accumulateur de id, créé si besoin (NULL si MAX_CGROUPS cgroups sont actifs)
+static CgroupAcc *acc_get(int id) {
+    CgroupAcc *a = acc_find(id);
+    if (a) return a;
+    static unsigned int full_epoch = 0; // plus de MAX_CGROUPS actifs : une seule purge par tour
+    if (acc_used >= MAX_CGROUPS && full_epoch != acc_epoch) {
+        acc_purge(1);
+        if (acc_used >= MAX_CGROUPS) acc_purge(0); // renouvellement massif : seuls ceux de ce tour
+        if (acc_used >= MAX_CGROUPS) full_epoch = acc_epoch;
+    }
+    if (acc_used >= MAX_CGROUPS) return NULL;
+    unsigned int i = hash_id(id) & (CGROUP_ACC_SIZE - 1);
+    while (acc[i].id != 0) i = (i + 1) & (CGROUP_ACC_SIZE - 1);
+    a = &acc[i];
+    memset(a, 0, sizeof(*a));
+    a->id = id;
+    acc_used++;
+    return a;
+}
+
+const char *cgroup_path(int id) {
+    return (id > 0 && strpool_valid(id)) ? strpool_get(id) : NULL;
+}
+
+int cgroup_lookup_pid(const char *pid_str) {
+    char path[512], buf[4096];
+    snprintf(path, sizeof(path), "%s/%s/cgroup", process_proc_root(), pid_str);
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) return -1;
+
+    // Format "hierarchie:controleurs:chemin" par ligne.
+    // cgroup v2 : une seule ligne "0::/chemin". En v1 on retient la hiérarchie
+    // "cpu" (ou une autre hiérarchie non racine à défaut).
+    char *chosen = NULL;
+    for (char *line = strtok(buf, "\n"); line; line = strtok(NULL, "\n")) {
+        char *c1 = strchr(line, ':');
+        char *c2 = c1 ? strchr(c1 + 1, ':') : NULL;
+        if (!c2) continue;
+        if (strncmp(line, "0::", 3) == 0) {
+            chosen = c2 + 1;
+            if (strcmp(chosen, "/") != 0) break; // mode hybride : la racine v2 n'apprend rien
+            continue;
+        }
+        *c2 = '\0';
+        if (!chosen || strcmp(chosen, "/") == 0 || strstr(c1 + 1, "cpu")) chosen = c2 + 1;
+    }
+    if (!chosen) return -1;
+    size_t len = strlen(chosen);
+    if (len >= MAX_CGROUP_PATH) len = MAX_CGROUP_PATH - 1;
+    int id = strpool_intern(chosen, len);
+    return (id > 0) ? id : -1;
+}
+
+// Lit une valeur "clé N" dans un fichier du cgroup v2 (clé NULL : premier nombre)
+static int read_cgroup_value(const char *cg_path, const char *file, const char *key,
+                             unsigned long long *value) {
+    char path[MAX_CGROUP_PATH + 64], buf[1024];
+    snprintf(path, sizeof(path), CGROUP_V2_ROOT "%s/%s", cg_path, file);
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) return 0;
+
+    const char *p = buf;
+    if (key) {
+        size_t len = strlen(key);
+        while (p && !(strncmp(p, key, len) == 0 && p[len] == ' ')) {
+            p = strchr(p, '\n');
+            if (p) p++;
+        }
+        if (!p) return 0;
+        p += len;
+    }
+    return sscanf(p, "%llu", value) == 1;
+}
+
+// Compteurs exacts du cgroup v2 : memory.current et usage_usec de cpu.stat
+static void read_exact(CgroupAcc *a, double now, long ncpu) {
+    unsigned long long mem = 0, usage = 0;
+    CgroupStats *st = &a->stats;
+    st->exact_valid = 0;
+    if (!read_cgroup_value(st->path, "cpu.stat", "usage_usec", &usage)) return;
+    read_cgroup_value(st->path, "memory.current", NULL, &mem);
+
+    st->exact_mem = (unsigned long)mem;
+    st->exact_cpu_percent = 0.0;
+    if (a->prev_time > 0 && now > a->prev_time && usage >= a->prev_usage_usec) {
+        // même normalisation que le CPU% des processus : 100% = toute la machine
+        st->exact_cpu_percent = 100.0 * (usage - a->prev_usage_usec) / ((now - a->prev_time) * 1e6 * ncpu);
+    }
+    a->prev_usage_usec = usage;
+    a->prev_time = now;
+    st->exact_valid = 1;
+}
+
+static int compare_cgroup_cpu(const void *a, const void *b) {
+    const CgroupStats *ga = (const CgroupStats *)a;
+    const CgroupStats *gb = (const CgroupStats *)b;
+    if (ga->cpu_percent < gb->cpu_percent) return 1;
+    if (ga->cpu_percent > gb->cpu_percent) return -1;
+    return ga->procs < gb->procs ? 1 : (ga->procs > gb->procs ? -1 : 0);
+}
+
+int cgroup_aggregate(const ProcessInfo processes[], int count,
+                     CgroupStats out[], int max_out, int exact) {
+    acc_epoch++;
+    static int active[MAX_CGROUPS];
+    int nactive = 0;
+
+    for (int i = 0; i < count; i++) {
+        int id = processes[i].cgroup_id;
+        const char *path = cgroup_path(id);
+        if (!path) continue;
+        CgroupAcc *a = acc_get(id); // une purge peut déplacer les entrées : active[] garde les ids
+        if (!a) continue;
+        if (a->epoch != acc_epoch) { // première rencontre de ce cgroup ce tour-ci
+            a->epoch = acc_epoch;
+            a->stats.id = id;
+            a->stats.path = path;
+            a->stats.procs = 0;
+            a->stats.cpu_percent = 0.0;
+            a->stats.rss = 0;
+            a->stats.mem_percent = 0.0;
+            a->stats.exact_valid = 0;
+            active[nactive++] = id;
+        }
+        a->stats.procs++;
+        a->stats.cpu_percent += processes[i].cpu_percent;
+        a->stats.rss += processes[i].res;
+        a->stats.mem_percent += processes[i].mem_percent;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = ts.tv_sec + ts.tv_nsec / 1e9;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+
+    int n = 0;
+    for (int i = 0; i < nactive && n < max_out; i++) {
+        CgroupAcc *a = acc_find(active[i]);
+        if (exact) read_exact(a, now, ncpu);
+        out[n++] = a->stats;
+    }
+    // seuls les groupes (quelques dizaines) sont triés, pas les processus
+    qsort(out, n, sizeof(CgroupStats), compare_cgroup_cpu);
+    return n;
+}
@@ -0,0 +1,39 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include "process.h"
+
+#define MAX_CGROUPS 4096            // cgroups ayant des processus en même temps
+#define MAX_CGROUP_PATH 512
+
+// Agrégat par cgroup (conteneur, pod, service systemd...)
+typedef struct {
+    int id;                       // identifiant du chemin dans le pool de chaînes
+    const char *path;             // chemin du cgroup ("/kubepods/.../<id>")
+    int procs;                    // nombre de processus
+    double cpu_percent;           // somme des CPU% des processus
+    unsigned long rss;            // somme des RES (octets)
+    double mem_percent;           // somme des MEM%
+
+    // Valeurs exactes lues dans le cgroup v2 (cpu.stat, memory.current)
+    int exact_valid;
+    double exact_cpu_percent;
+    unsigned long exact_mem;
+} CgroupStats;
+
+// Lit /proc/<pid>/cgroup et retourne l'identifiant du chemin dans le pool de
+// chaînes (strpool.h, > 0), ou -1 si le fichier est illisible. L'appelant
+// garde l'identifiant et le touche à chaque collecte : le chemin d'un
+// conteneur disparu quitte le pool après STRPOOL_TTL.
+int cgroup_lookup_pid(const char *pid_str);
+
+// Chemin associé à un identifiant (NULL si inconnu ou périmé)
+const char *cgroup_path(int id);
+
+// Cumule les processus par cgroup (une passe, accumulateurs indexés par id)
+// puis complète avec les compteurs cgroup v2 si exact != 0.
+// Retourne le nombre de cgroups écrits dans out[], triés par CPU% décroissant.
+int cgroup_aggregate(const ProcessInfo processes[], int count,
+                     CgroupStats out[], int max_out, int exact);
+
+#endif
@@ -0,0 +1,165 @@
+#define _GNU_SOURCE // basename() de string.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "confwatch.h"
+#include "network.h"
+#include "alert.h"
+#include "metrics.h"
+
+static int watch_fd = -1;
+static char watch_path[MAX_PATH_LEN];
+static char watch_name[MAX_PATH_LEN];   // nom du fichier dans le répertoire surveillé
+
+int confwatch_open(const char *path) {
+    if (strlen(path) >= sizeof(watch_path)) return -1;
+    strcpy(watch_path, path);
+    strcpy(watch_name, basename(path));
+
+    char dir[MAX_PATH_LEN];
+    const char *slash = strrchr(path, '/');
+    if (!slash) strcpy(dir, ".");
+    else if (slash == path) strcpy(dir, "/");
+    else snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return -1;
+    // fin d'écriture, remplacement par rename, chmod (le fichier doit être en 0600).
+    // IN_CREATE est ignoré : le fichier est encore vide à ce moment-là
+    if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB) < 0) {
+        close(fd);
+        return -1;
+    }
+    watch_fd = fd;
+    return 0;
+}
+
+int confwatch_fd(void) {
+    return watch_fd;
+}
+
+int confwatch_changed(void) {
+    if (watch_fd < 0) return 0;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    ssize_t n;
+    while ((n = read(watch_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            if (ev->len > 0 && strcmp(ev->name, watch_name) == 0) changed = 1;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    return changed;
+}
+
+// Même hôte : mêmes paramètres de connexion (le nom affiché peut changer sans reconnexion)
+static int same_host(const RemoteHost *a, const RemoteHost *b) {
+    return a->port == b->port &&
+           strcmp(a->address, b->address) == 0 &&
+           strcmp(a->username, b->username) == 0 &&
+           strcmp(a->password, b->password) == 0 &&
+           strcmp(a->connection_type, b->connection_type) == 0;
+}
+
+int confwatch_reload(ManagerConfig *cfg, ssh_session sessions[], int from[MAX_HOSTS]) {
+    if (watch_fd < 0 || check_file_permissions(watch_path) != 1) return -1;
+
+    // nouvelle liste, construite comme au démarrage : fichier puis hôte de -s/-l
+    static ManagerConfig next;
+    next.host_count = 0;
+    parse_config_file(watch_path, &next);
+    if (cfg->cli_host_defined && next.host_count < MAX_HOSTS) next.hosts[next.host_count++] = cfg->cli_host;
+    int n = next.host_count;
+
+    // hôtes conservés : next -> ancien index
+    int old_of[MAX_HOSTS], kept[MAX_HOSTS] = {0};
+    for (int j = 0; j < n; j++) {
+        old_of[j] = -1;
+        for (int i = 0; i < cfg->host_count; i++) {
+            if (!kept[i] && same_host(&cfg->hosts[i], &next.hosts[j])) {
+                old_of[j] = i;
+                kept[i] = 1;
+                break;
+            }
+        }
+    }
+
+    // Un hôte conservé garde son index s'il est < n ; les places libres
+    // (hôtes retirés) reçoivent, dans l'ordre, les conservés d'index >= n puis
+    // les nouveaux : cfg->hosts reste compact.
+    int slot_of[MAX_HOSTS], used[MAX_HOSTS] = {0};
+    for (int j = 0; j < n; j++) {
+        slot_of[j] = (old_of[j] >= 0 && old_of[j] < n) ? old_of[j] : -1;
+        if (slot_of[j] >= 0) used[slot_of[j]] = 1;
+    }
+    int slot = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int j = 0; j < n; j++) {
+            if (slot_of[j] >= 0 || (pass == 0) != (old_of[j] >= 0)) continue;
+            while (used[slot]) slot++;
+            slot_of[j] = slot;
+            used[slot] = 1;
+        }
+    }
+
+    int added = 0, removed = 0;
+    for (int i = 0; i < cfg->host_count; i++) {
+        if (kept[i]) continue;
+        if (cfg->hosts[i].enabled && sessions[i]) network_disconnect(sessions[i]);
+        printf("Hôte retiré : %s\n", cfg->hosts[i].display_name);
+        removed++;
+    }
+
+    static RemoteHost hosts[MAX_HOSTS];
+    ssh_session conn[MAX_HOSTS] = {0};
+    for (int i = 0; i < MAX_HOSTS; i++) from[i] = -1;
+    for (int j = 0; j < n; j++) {
+        int s = slot_of[j], i = old_of[j];
+        from[s] = i;
+        if (i >= 0) {
+            hosts[s] = cfg->hosts[i];
+            conn[s] = sessions[i];
+            memcpy(hosts[s].display_name, next.hosts[j].display_name, MAX_NAME_LEN);
+            if (hosts[s].enabled) continue;
+            // hôte en échec au chargement précédent : nouvelle tentative
+        } else {
+            hosts[s] = next.hosts[j];
+            added++;
+        }
+        if (network_connect(&hosts[s], &conn[s]) != 0) {
+            printf("Connexion échouée vers %s\n", hosts[s].display_name);
+            hosts[s].enabled = 0;
+            conn[s] = NULL;
+        } else {
+            printf("Connexion réussie vers %s\n", hosts[s].display_name);
+            hosts[s].enabled = 1;
+        }
+    }
+
+    // état par source (alertes, export) des index qui changent d'hôte
+    int old_count = cfg->host_count;
+    for (int s = 0; s < MAX_HOSTS; s++) {
+        if (s < n) {
+            cfg->hosts[s] = hosts[s];
+            sessions[s] = conn[s];
+        } else {
+            sessions[s] = NULL;
+        }
+        if ((s < n || s < old_count) && from[s] != s) {
+            alert_reset_source(s);
+            metrics_drop_source(s);
+        }
+    }
+    cfg->host_count = n;
+    cfg->collect_remote = (n > 0);
+    if (added || removed) printf("Configuration rechargée : %d hôte(s) ajouté(s), %d retiré(s)\n", added, removed);
+    return added + removed;
+}
+
+void confwatch_close(void) {
+    if (watch_fd >= 0) close(watch_fd);
+    watch_fd = -1;
+}
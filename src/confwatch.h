@@ -0,0 +1,31 @@
+#ifndef CONFWATCH_H
+#define CONFWATCH_H
+
+#include <libssh/libssh.h>
+#include "manager.h"
+
+// Rechargement à chaud du fichier d'hôtes (.config ou -c).
+//
+// Le répertoire du fichier est surveillé par inotify (les éditeurs remplacent
+// souvent le fichier par un rename) ; à chaque écriture terminée, la nouvelle
+// liste est comparée à la courante. Seuls les hôtes ajoutés sont connectés et
+// seuls les hôtes retirés déconnectés : les autres gardent leur session, leur
+// index dans cfg->hosts et leur historique (rafraîchissement, alertes).
+
+// Surveille path (qui peut ne pas encore exister). Retourne 0, ou -1.
+int confwatch_open(const char *path);
+int confwatch_fd(void);                // descripteur inotify (pour poll), -1 si inactif
+
+// Vide les événements en attente sans bloquer. Retourne 1 si le fichier a changé.
+int confwatch_changed(void);
+
+// Relit le fichier et applique la différence à cfg->hosts et sessions[].
+// from[i] reçoit l'ancien index de l'hôte désormais en i (-1 : nouvel hôte) :
+// l'appelant y déplace son état par hôte, un hôte resté en place a from[i] == i.
+// Retourne le nombre d'hôtes ajoutés ou retirés, ou -1 si le fichier est
+// illisible ou a de mauvais droits (configuration courante conservée).
+int confwatch_reload(ManagerConfig *cfg, ssh_session sessions[], int from[MAX_HOSTS]);
+
+void confwatch_close(void);
+
+#endif
@@ -0,0 +1,424 @@
+#define _GNU_SOURCE // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "daemon.h"
+#include "network.h"
+#include "refresh.h"
+#include "filter.h"
+#include "profile.h"
+#include "shmexport.h"
+#include "metrics.h"
+#include "alert.h"
+#include "confwatch.h"
+
+// Dernier instantané de chaque source, partagé par tous les clients
+typedef struct {
+    int host;                 // -1 : machine locale, sinon index dans cfg->hosts
+    char name[DAEMON_NAME_LEN];
+    ProcessInfo rows[MAX_PROCESSES];
+    int count;
+    char *strings;            // chaînes des lignes, dans l'ordre (voir daemon.h)
+    size_t strings_len, strings_cap;
+    uint64_t seq;             // 0 : jamais collectée
+    double collected_at;
+    double last_request;      // dernière demande d'un client
+    RefreshState refresh;
+} Source;
+
+static Source sources[DAEMON_MAX_SOURCES];
+static int nsources = 0;
+static uint64_t last_seq = 0;  // numéros d'instantanés communs à toutes les sources
+
+// État de la collecte locale
+static PidTable local_table;
+static SystemStats local_stats;
+static unsigned long long prev_total_cpu = 0;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+void daemon_default_path(char *buf, size_t size) {
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    if (runtime && runtime[0]) {
+        snprintf(buf, size, "%s/my_htop.sock", runtime);
+    } else {
+        snprintf(buf, size, "/tmp/my_htop-%u.sock", (unsigned)getuid());
+    }
+}
+
+// Lecture/écriture complètes (la socket peut découper les transferts)
+static int read_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int writev_full(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// Chaînes des lignes mises bout à bout, une fois par collecte (et non par client)
+static void pack_strings(Source *src) {
+    src->strings_len = 0;
+    for (int i = 0; i < src->count; i++) {
+        const char *str[4] = { process_user(&src->rows[i]), process_name(&src->rows[i]),
+                               process_cmdline(&src->rows[i]), process_affinity(&src->rows[i]) };
+        for (int k = 0; k < 4; k++) {
+            size_t len = strlen(str[k]) + 1;
+            if (src->strings_len + len > src->strings_cap) {
+                size_t cap = src->strings_cap ? src->strings_cap * 2 : 64 * 1024;
+                while (cap < src->strings_len + len) cap *= 2;
+                char *p = realloc(src->strings, cap);
+                if (!p) { src->count = i; return; } // lignes sans chaînes : non servies
+                src->strings = p;
+                src->strings_cap = cap;
+            }
+            memcpy(src->strings + src->strings_len, str[k], len);
+            src->strings_len += len;
+        }
+    }
+}
+
+static void collect_source(Source *src, ssh_session sessions[], double now) {
+    double cpu_start = refresh_cpu_time();
+    double activity;
+    unsigned long bytes = 0;
+
+    prof_frame_begin(src->name);
+    if (src->host < 0) {
+        sysstats_update(&local_stats);
+        unsigned long long curr_total = sysstats_cpu_total(&local_stats.total);
+        src->count = process_collect_all(src->rows, MAX_PROCESSES, prev_total_cpu, &local_table, curr_total,
+                                         COLLECT_FIELDS | alert_collect_flags());
+        prev_total_cpu = curr_total;
+        activity = local_stats.total_percent / 100.0;
+        shmexport_publish(src->rows, src->count, &local_stats);
+    } else {
+        src->count = network_collect(sessions[src->host], src->rows, MAX_PROCESSES);
+        activity = 0;
+        for (int i = 0; i < src->count; i++) activity += src->rows[i].cpu_percent / 100.0;
+        if (activity > 1) activity = 1;
+    }
+    prof_frame_end();
+    // toutes les sources sont collectées ici : chaque règle voit chaque instantané
+    alert_evaluate(src->host, src->name, src->rows, src->count);
+    metrics_publish(src->host, src->name, src->rows, src->count, src->host < 0 ? &local_stats : NULL);
+    if (src->host >= 0) bytes = prof_last_frame()->counters.bytes_read;
+    pack_strings(src);
+
+    // numérotation commune : une source qui reprend l'index d'une autre après
+    // un rechargement ne peut pas être prise pour « inchangée » par un client
+    src->seq = ++last_seq;
+    src->collected_at = now;
+    int viewed = (now - src->last_request < DAEMON_VIEW_TIMEOUT);
+    refresh_record(&src->refresh, now, refresh_cpu_time() - cpu_start, bytes, activity, src->count, viewed);
+}
+
+static int serve_request(int fd) {
+    DaemonRequest req;
+    DaemonReply reply;
+    if (read_full(fd, &req, sizeof(req)) != 0 || req.magic != DAEMON_MAGIC) return -1;
+
+    memset(&reply, 0, sizeof(reply));
+    reply.magic = DAEMON_MAGIC;
+    reply.version = DAEMON_VERSION;
+    reply.record_size = sizeof(ProcessInfo);
+    reply.source = req.source;
+    reply.nsources = nsources;
+    for (int i = 0; i < nsources; i++) memcpy(reply.names[i], sources[i].name, DAEMON_NAME_LEN);
+
+    struct iovec iov[4];
+    int iovcnt = 1;
+    iov[0].iov_base = &reply;
+    iov[0].iov_len = sizeof(reply);
+
+    if (req.source < 0 || req.source >= nsources || sources[req.source].seq == 0) {
+        reply.status = DAEMON_NO_SOURCE;
+    } else {
+        Source *src = &sources[req.source];
+        double now = refresh_now();
+        src->last_request = now;
+        reply.seq = src->seq;
+        reply.age = now - src->collected_at;
+        if (req.last_seq == src->seq) {
+            reply.status = DAEMON_UNCHANGED;
+        } else {
+            reply.status = DAEMON_OK;
+            reply.count = src->count;
+            if (src->host < 0) {
+                reply.has_stats = 1;
+                iov[iovcnt].iov_base = &local_stats;
+                iov[iovcnt++].iov_len = sizeof(local_stats);
+            }
+            iov[iovcnt].iov_base = src->rows;
+            iov[iovcnt++].iov_len = sizeof(ProcessInfo) * src->count;
+            reply.strings_len = (int32_t)src->strings_len;
+            iov[iovcnt].iov_base = src->strings;
+            iov[iovcnt++].iov_len = src->strings_len;
+        }
+    }
+    return writev_full(fd, iov, iovcnt);
+}
+
+static int open_listener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Chemin de socket trop long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Une socket restante n'est supprimée que si plus aucun démon n'y répond
+    int probe = daemon_connect(path);
+    if (probe >= 0) {
+        close(probe);
+        fprintf(stderr, "Un démon écoute déjà sur %s\n", path);
+        return -1;
+    }
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    chmod(path, 0660); // propriétaire et groupe : les utilisateurs du groupe partagent le démon
+    return fd;
+}
+
+static Source *add_source(int host, const char *name) {
+    Source *src = &sources[nsources++];
+    src->host = host;
+    snprintf(src->name, sizeof(src->name), "%s", name);
+    src->count = 0;
+    src->strings = NULL;
+    src->strings_len = src->strings_cap = 0;
+    src->seq = 0;
+    src->last_request = 0;
+    refresh_init(&src->refresh);
+    if (host < 0 && process_watch_active()) refresh_set_fixed(&src->refresh, REFRESH_WATCH_INTERVAL);
+    return src;
+}
+
+// Fichier d'hôtes modifié : les sources des hôtes restés en place gardent leur
+// instantané et leur rythme, les autres sont recréées (collectées au prochain tour)
+static void reload_hosts(ManagerConfig *cfg, ssh_session sessions[]) {
+    int from[MAX_HOSTS];
+    if (confwatch_reload(cfg, sessions, from) < 0) {
+        printf("Démon: configuration illisible ou droits incorrects, hôtes inchangés\n");
+        fflush(stdout);
+        return;
+    }
+    int kept_host[MAX_HOSTS] = {0}, n = 0;
+    for (int i = 0; i < nsources; i++) {
+        int h = sources[i].host;
+        if (h >= 0 && (h >= cfg->host_count || from[h] != h || !cfg->hosts[h].enabled)) {
+            free(sources[i].strings);
+            continue;
+        }
+        if (h >= 0) {
+            kept_host[h] = 1;
+            snprintf(sources[i].name, sizeof(sources[i].name), "%s", cfg->hosts[h].display_name);
+        }
+        if (n != i) sources[n] = sources[i];
+        n++;
+    }
+    nsources = n;
+    for (int h = 0; h < cfg->host_count && nsources < DAEMON_MAX_SOURCES; h++) {
+        if (!kept_host[h] && cfg->hosts[h].enabled) add_source(h, cfg->hosts[h].display_name);
+    }
+    refresh_set_sources(nsources);
+    printf("Démon: %d source(s) après rechargement\n", nsources);
+    fflush(stdout);
+}
+
+int daemon_run(ManagerConfig *cfg, ssh_session sessions[], const char *path) {
+    int listen_fd = open_listener(path);
+    if (listen_fd < 0) return -1;
+
+    nsources = 0;
+    if (cfg->collect_local) add_source(-1, "local");
+    for (int i = 0; i < cfg->host_count && nsources < DAEMON_MAX_SOURCES; i++) {
+        if (cfg->hosts[i].enabled) add_source(i, cfg->hosts[i].display_name);
+    }
+    refresh_set_sources(nsources);
+
+    if (cfg->collect_local) {
+        process_initial_scan(&local_table);
+        sysstats_update(&local_stats);
+        prev_total_cpu = sysstats_cpu_total(&local_stats.total);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop; // sans SA_RESTART : poll() est interrompu
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Démon: %d source(s), socket %s\n", nsources, path);
+    fflush(stdout);
+
+    // descripteurs fixes (-1 : inactif, ignoré par poll), puis les clients,
+    // puis ceux de l'export OpenMetrics (recalculés à chaque tour)
+    enum { FD_LISTEN, FD_CONFIG, FD_CLIENTS };
+    struct pollfd fds[FD_CLIENTS + DAEMON_MAX_CLIENTS + METRICS_MAX_CLIENTS + 1];
+    int nclients = 0;
+    fds[FD_LISTEN].fd = listen_fd;
+    fds[FD_CONFIG].fd = confwatch_fd();
+    for (int i = 0; i < FD_CLIENTS; i++) {
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    while (!stop_requested) {
+        // Collecte des sources dues, puis attente jusqu'à la prochaine échéance
+        double now = refresh_now();
+        double wait = 1.0;
+        for (int i = 0; i < nsources; i++) {
+            Source *src = &sources[i];
+            if (refresh_due(&src->refresh, now)) {
+                collect_source(src, sessions, now);
+                now = refresh_now();
+            }
+            double left = src->refresh.last_run + src->refresh.interval - now;
+            if (left < wait) wait = left;
+        }
+        int timeout_ms = (wait < 0.01) ? 10 : (int)(wait * 1000);
+
+        int nmetrics = metrics_poll_fds(fds + FD_CLIENTS + nclients);
+        int ready = poll(fds, FD_CLIENTS + nclients + nmetrics, timeout_ms);
+        if (nmetrics) metrics_serve(); // aussi sans événement : coupe les clients trop lents
+        if (ready <= 0) continue;
+
+        for (int i = FD_CLIENTS; i < FD_CLIENTS + nclients; i++) {
+            if (!fds[i].revents) continue;
+            if ((fds[i].revents & POLLIN) && serve_request(fds[i].fd) == 0) continue;
+            close(fds[i].fd); // déconnexion ou requête invalide
+            fds[i] = fds[FD_CLIENTS + --nclients];
+            i--;
+        }
+        if ((fds[FD_CONFIG].revents & POLLIN) && confwatch_changed()) reload_hosts(cfg, sessions);
+        if (fds[FD_LISTEN].revents & POLLIN) {
+            int fd;
+            while ((fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+                if (nclients >= DAEMON_MAX_CLIENTS) { close(fd); continue; }
+                // un client qui ne lit plus ne bloque pas le démon plus d'une seconde
+                struct timeval tv = { 1, 0 };
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                fds[FD_CLIENTS + nclients].fd = fd;
+                fds[FD_CLIENTS + nclients].events = POLLIN;
+                fds[FD_CLIENTS + nclients].revents = 0;
+                nclients++;
+            }
+        }
+    }
+
+    for (int i = FD_CLIENTS; i < FD_CLIENTS + nclients; i++) close(fds[i].fd);
+    close(listen_fd);
+    unlink(path);
+    if (cfg->collect_local) pidtable_free(&local_table);
+    for (int i = 0; i < nsources; i++) free(sources[i].strings);
+    printf("Démon arrêté\n");
+    return 0;
+}
+
+int daemon_connect(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int daemon_fetch(int fd, int source, uint64_t last_seq, DaemonReply *reply,
+                 SystemStats *stats, ProcessInfo rows[], int max_rows) {
+    DaemonRequest req = { DAEMON_MAGIC, source, last_seq };
+    struct iovec iov = { &req, sizeof(req) };
+    if (writev_full(fd, &iov, 1) != 0) return -1;
+    if (read_full(fd, reply, sizeof(*reply)) != 0) return -1;
+    if (reply->magic != DAEMON_MAGIC || reply->version != DAEMON_VERSION ||
+        reply->record_size != sizeof(ProcessInfo)) return -1;
+    if (reply->status != DAEMON_OK) return 0;
+
+    if (reply->has_stats && read_full(fd, stats, sizeof(*stats)) != 0) return -1;
+    int count = reply->count;
+    int kept = (count < max_rows) ? count : max_rows;
+    if (read_full(fd, rows, sizeof(ProcessInfo) * kept) != 0) return -1;
+    for (int i = kept; i < count; i++) { // surplus : lu et ignoré
+        ProcessInfo skip;
+        if (read_full(fd, &skip, sizeof(skip)) != 0) return -1;
+    }
+
+    // chaînes : réinternées dans le pool local, les identifiants reçus sont ceux du démon
+    static char *strings = NULL;
+    static size_t strings_cap = 0;
+    size_t len = (reply->strings_len > 0) ? (size_t)reply->strings_len : 0;
+    if (len + 1 > strings_cap) {
+        char *p = realloc(strings, len + 1);
+        if (!p) return -1;
+        strings = p;
+        strings_cap = len + 1;
+    }
+    if (read_full(fd, strings, len) != 0) return -1;
+    strings[len] = '\0';
+    const char *s = strings, *end = strings + len;
+    for (int i = 0; i < kept; i++) {
+        int *ids[4] = { &rows[i].user_id, &rows[i].name_id, &rows[i].cmd_id, &rows[i].affinity_id };
+        for (int k = 0; k < 4; k++) {
+            size_t n = (s < end) ? strlen(s) : 0;
+            *ids[k] = strpool_intern(s, n);
+            s += (s < end) ? n + 1 : 0;
+        }
+    }
+    strpool_collect();
+    return kept;
+}
@@ -0,0 +1,68 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stdint.h>
+#include <libssh/libssh.h>
+#include "manager.h"
+#include "process.h"
+#include "sysstats.h"
+
+// Mode démon : une seule collecte (locale et distante) servie à plusieurs
+// interfaces par une socket Unix. Le client envoie une DaemonRequest, le démon
+// répond par une DaemonReply suivie, si status == DAEMON_OK, de SystemStats
+// (has_stats), de count enregistrements ProcessInfo et de strings_len octets
+// de chaînes : pour chaque enregistrement, utilisateur, nom, ligne de
+// commande et coeurs autorisés, terminés par '\0' (les identifiants du pool de chaînes n'ont pas
+// de sens d'un processus à l'autre ; le client les réinterne). Les deux côtés
+// sont le même binaire : record_size sert de garde-fou contre un démon d'une
+// autre version.
+
+#define DAEMON_MAGIC 0x4d485450u   // "MHTP"
+#define DAEMON_VERSION 4
+#define DAEMON_MAX_SOURCES (MAX_HOSTS + 1)
+#define DAEMON_NAME_LEN MAX_NAME_LEN  // nom complet : règles "on HÔTE" et étiquettes des métriques
+#define DAEMON_MAX_CLIENTS 64
+#define DAEMON_VIEW_TIMEOUT 5.0    // source considérée affichée si demandée depuis moins de 5 s
+
+enum {
+    DAEMON_OK = 0,
+    DAEMON_UNCHANGED = 1,   // même seq que last_seq : pas d'enregistrements
+    DAEMON_NO_SOURCE = 2,   // source inconnue ou pas encore collectée
+};
+
+typedef struct {
+    uint32_t magic;
+    int32_t source;         // 0 .. nsources-1
+    uint64_t last_seq;      // dernier instantané reçu par le client (0 : aucun)
+} DaemonRequest;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;   // sizeof(ProcessInfo) côté démon
+    int32_t status;
+    int32_t source;
+    int32_t nsources;
+    int32_t count;
+    int32_t has_stats;      // source locale : SystemStats suit l'en-tête
+    int32_t strings_len;    // octets de chaînes après les enregistrements
+    uint64_t seq;           // numéro de l'instantané, croissant par source
+    double age;             // âge de l'instantané en secondes
+    char names[DAEMON_MAX_SOURCES][DAEMON_NAME_LEN];
+} DaemonReply;
+
+// Chemin par défaut : $XDG_RUNTIME_DIR/my_htop.sock, sinon /tmp/my_htop-<uid>.sock
+void daemon_default_path(char *buf, size_t size);
+
+// Boucle du démon (ne rend la main qu'à SIGINT/SIGTERM). sessions[i] est la
+// session de cfg->hosts[i] (NULL si déconnecté). Retourne 0, ou -1 si la
+// socket n'a pas pu être créée.
+int daemon_run(ManagerConfig *cfg, ssh_session sessions[], const char *path);
+
+// Côté client
+int daemon_connect(const char *path);   // descripteur, ou -1
+// Retourne count (>= 0), ou -1 si la connexion est perdue ou incompatible
+int daemon_fetch(int fd, int source, uint64_t last_seq, DaemonReply *reply,
+                 SystemStats *stats, ProcessInfo rows[], int max_rows);
+
+#endif
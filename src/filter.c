@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "filter.h"
+
+static Filter active_filter; // count == 0 : tout passe
+
+// comm est imprimé sur 15 colonnes (comm:15, voir network.c) et peut contenir
+// des espaces ("Web Content") : awk le découperait. On le prend donc tel quel,
+// après les 11 premières colonnes, repérées par match() (RLENGTH)
+#define AWK_COMM (-1)
+#define AWK_COMM_WIDTH 15
+#define AWK_COMM_SKIP "/^ *[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +[^ ]+ +/"
+
+#define FILTER_SIZE_MAX 1e18 // octets (~1 Eio) : au-delà, valeur de taille refusée
+
+static const struct {
+    const char *name;
+    FilterField field;
+    int stage;
+    int is_text;
+    int is_size;       // accepte les suffixes K/M/G
+    int awk_column;    // colonne de "ps -o pid,user,state,pri,ni,vsz,rss,pmem,pcpu,times,psr,comm:15,args"
+                       // (0 : pas d'équivalent, terme évalué après réception ;
+                       // AWK_COMM : comm, qui peut contenir des espaces)
+} fields[] = {
+    { "pid",   FF_PID,   FILTER_STAGE_STAT,  0, 0, 1 },
+    { "user",  FF_USER,  FILTER_STAGE_USER,  1, 0, 2 },
+    { "name",  FF_NAME,  FILTER_STAGE_STAT,  1, 0, AWK_COMM },
+    { "state", FF_STATE, FILTER_STAGE_STAT,  1, 0, 3 },
+    { "cpu",   FF_CPU,   FILTER_STAGE_STAT,  0, 0, 9 },
+    { "mem",   FF_MEM,   FILTER_STAGE_STATM, 0, 0, 8 },
+    { "rss",   FF_RSS,   FILTER_STAGE_STATM, 0, 1, 7 },
+    { "virt",  FF_VIRT,  FILTER_STAGE_STATM, 0, 1, 6 },
+    { "nice",  FF_NICE,  FILTER_STAGE_STAT,  0, 0, 5 },
+    { "pri",   FF_PRI,   FILTER_STAGE_STAT,  0, 0, 4 },
+    { "psr",   FF_PSR,   FILTER_STAGE_STAT,  0, 0, 11 },
+    { "node",  FF_NODE,  FILTER_STAGE_STAT,  0, 0, 0 },
+};
+#define NFIELDS ((int)(sizeof(fields) / sizeof(fields[0])))
+
+// Opérateurs, les plus longs d'abord pour que ">=" ne soit pas lu comme ">"
+static const struct { const char *text; FilterOp op; } ops[] = {
+    { ">=", FO_GE }, { "<=", FO_LE }, { "!=", FO_NE }, { "!~", FO_NOT_CONTAINS },
+    { "=", FO_EQ }, { ">", FO_GT }, { "<", FO_LT }, { "~", FO_CONTAINS },
+};
+#define NOPS ((int)(sizeof(ops) / sizeof(ops[0])))
+
+static int field_index(FilterField field) {
+    for (int i = 0; i < NFIELDS; i++) {
+        if (fields[i].field == field) return i;
+    }
+    return 0;
+}
+
+// Les valeurs sont recopiées telles quelles dans la commande distante :
+// on n'accepte qu'un jeu de caractères sans danger pour le shell et awk
+static int is_safe_value(const char *v) {
+    if (!*v) return 0;
+    for (; *v; v++) {
+        if (!isalnum((unsigned char)*v) && !strchr("_.:@+/-", *v)) return 0;
+    }
+    return 1;
+}
+
+// "512", "1.5K", "8G" -> octets
+static int parse_size(const char *v, double *out) {
+    char *end;
+    double n = strtod(v, &end);
+    if (end == v) return 0;
+    switch (toupper((unsigned char)*end)) {
+        case '\0': break;
+        case 'K': n *= 1024.0; end++; break;
+        case 'M': n *= 1024.0 * 1024.0; end++; break;
+        case 'G': n *= 1024.0 * 1024.0 * 1024.0; end++; break;
+        default: return 0;
+    }
+    if (*end == 'B' || *end == 'b') end++;
+    // inf, nan ou 1e308 donneraient un littéral awk inutilisable (%.0f)
+    if (!isfinite(n) || n > FILTER_SIZE_MAX || n < -FILTER_SIZE_MAX) return 0;
+    *out = n;
+    return *end == '\0';
+}
+
+static int compile_term(const char *token, FilterTerm *t, char *err, size_t err_size) {
+    // repérage de l'opérateur (premier caractère d'opérateur rencontré)
+    size_t name_len = strcspn(token, "=<>!~");
+    if (name_len == 0 || token[name_len] == '\0') {
+        snprintf(err, err_size, "terme invalide '%s' (attendu: champ op valeur)", token);
+        return -1;
+    }
+
+    int fi = -1;
+    for (int i = 0; i < NFIELDS; i++) {
+        if (strlen(fields[i].name) == name_len && strncmp(token, fields[i].name, name_len) == 0) fi = i;
+    }
+    if (fi < 0) {
+        snprintf(err, err_size, "champ inconnu dans '%s' (pid, user, name, state, cpu, mem, rss, virt, nice, pri, psr, node)", token);
+        return -1;
+    }
+
+    const char *op_text = token + name_len;
+    int oi = -1;
+    for (int i = 0; i < NOPS; i++) {
+        if (strncmp(op_text, ops[i].text, strlen(ops[i].text)) == 0) { oi = i; break; }
+    }
+    if (oi < 0) {
+        snprintf(err, err_size, "opérateur invalide dans '%s'", token);
+        return -1;
+    }
+    const char *value = op_text + strlen(ops[oi].text);
+
+    t->field = fields[fi].field;
+    t->op = ops[oi].op;
+    t->stage = fields[fi].stage;
+    t->num = 0.0;
+
+    if (!is_safe_value(value) || strlen(value) >= MAX_FILTER_VALUE) {
+        snprintf(err, err_size, "valeur invalide dans '%s'", token);
+        return -1;
+    }
+    strcpy(t->str, value);
+
+    int contains = (t->op == FO_CONTAINS || t->op == FO_NOT_CONTAINS);
+    if (fields[fi].is_text) {
+        if (!contains && t->op != FO_EQ && t->op != FO_NE) {
+            snprintf(err, err_size, "'%s' : seuls =, !=, ~ et !~ s'appliquent à un texte", token);
+            return -1;
+        }
+    } else {
+        if (contains) {
+            snprintf(err, err_size, "'%s' : ~ ne s'applique qu'aux champs texte", token);
+            return -1;
+        }
+        int ok;
+        if (fields[fi].is_size) {
+            ok = parse_size(value, &t->num);
+        } else {
+            char *end;
+            t->num = strtod(value, &end);
+            ok = (end != value && *end == '\0' && isfinite(t->num));
+        }
+        if (!ok) {
+            snprintf(err, err_size, "valeur numérique invalide dans '%s'", token);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int filter_compile(const char *expr, Filter *f, char *err, size_t err_size) {
+    char copy[MAX_FILTER_LEN];
+    Filter tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    if (strlen(expr) >= sizeof(copy)) {
+        snprintf(err, err_size, "expression trop longue");
+        return -1;
+    }
+    strcpy(copy, expr);
+
+    for (char *tok = strtok(copy, " \t\n"); tok; tok = strtok(NULL, " \t\n")) {
+        if (tmp.count >= MAX_FILTER_TERMS) {
+            snprintf(err, err_size, "trop de termes (max %d)", MAX_FILTER_TERMS);
+            return -1;
+        }
+        FilterTerm *t = &tmp.terms[tmp.count];
+        if (compile_term(tok, t, err, err_size) != 0) return -1;
+        tmp.stage_count[t->stage]++;
+        tmp.count++;
+    }
+    strcpy(tmp.source, expr);
+    tmp.source[strcspn(tmp.source, "\n")] = '\0';
+    *f = tmp;
+    return 0;
+}
+
+static int compare_num(FilterOp op, double a, double b) {
+    switch (op) {
+        case FO_EQ: return a == b;
+        case FO_NE: return a != b;
+        case FO_GT: return a > b;
+        case FO_LT: return a < b;
+        case FO_GE: return a >= b;
+        case FO_LE: return a <= b;
+        default:    return 0;
+    }
+}
+
+static int compare_text(FilterOp op, const char *a, const char *b) {
+    switch (op) {
+        case FO_EQ:           return strcmp(a, b) == 0;
+        case FO_NE:           return strcmp(a, b) != 0;
+        case FO_CONTAINS:     return strstr(a, b) != NULL;
+        case FO_NOT_CONTAINS: return strstr(a, b) == NULL;
+        default:              return 0;
+    }
+}
+
+static int match_term(const FilterTerm *t, const ProcessInfo *info) {
+    char state[2] = { info->state, '\0' };
+    switch (t->field) {
+        case FF_PID:   return compare_num(t->op, info->pid, t->num);
+        case FF_USER:  return compare_text(t->op, process_user(info), t->str);
+        case FF_NAME:  return compare_text(t->op, process_name(info), t->str);
+        case FF_STATE: return compare_text(t->op, state, t->str);
+        case FF_CPU:   return compare_num(t->op, info->cpu_percent, t->num);
+        case FF_MEM:   return compare_num(t->op, info->mem_percent, t->num);
+        case FF_RSS:   return compare_num(t->op, (double)info->res, t->num);
+        case FF_VIRT:  return compare_num(t->op, (double)info->virt, t->num);
+        case FF_NICE:  return compare_num(t->op, info->nice, t->num);
+        case FF_PRI:   return compare_num(t->op, info->priority, t->num);
+        case FF_PSR:   return compare_num(t->op, info->last_cpu, t->num);
+        case FF_NODE:  return compare_num(t->op, info->numa_node, t->num);
+    }
+    return 0;
+}
+
+int filter_match(const Filter *f, const ProcessInfo *info, int stage) {
+    if (f->stage_count[stage] == 0) return 1;
+    for (int i = 0; i < f->count; i++) {
+        if (f->terms[i].stage == stage && !match_term(&f->terms[i], info)) return 0;
+    }
+    return 1;
+}
+
+int filter_match_all(const Filter *f, const ProcessInfo *info) {
+    for (int i = 0; i < f->count; i++) {
+        if (!match_term(&f->terms[i], info)) return 0;
+    }
+    return 1;
+}
+
+int filter_to_awk(const Filter *f, char *buf, size_t size) {
+    static const char *awk_ops[] = { "==", "!=", ">", "<", ">=", "<=" };
+    size_t len = snprintf(buf, size, "NR==1");  // on garde l'en-tête de ps
+    if (f->count > 0 && len < size) len += snprintf(buf + len, size - len, "||(1");
+    int comm_located = 0;
+
+    for (int i = 0; i < f->count && len < size; i++) {
+        const FilterTerm *t = &f->terms[i];
+        int fi = field_index(t->field);
+        int col = fields[fi].awk_column;
+        if (col == 0) continue;
+        if (col == AWK_COMM) {
+            if (!comm_located) { // une fois : les termes suivants réutilisent RLENGTH
+                len += snprintf(buf + len, size - len, "&&match($0," AWK_COMM_SKIP ")");
+                comm_located = 1;
+                if (len >= size) break; // deux ajouts dans ce tour : place revérifiée
+            }
+            if (t->op == FO_CONTAINS || t->op == FO_NOT_CONTAINS) {
+                len += snprintf(buf + len, size - len, "&&index(substr($0,RLENGTH+1,%d),\"%s\")%s0",
+                                AWK_COMM_WIDTH, t->str, t->op == FO_CONTAINS ? ">" : "==");
+            } else { // la tranche est complétée par des espaces : la valeur aussi
+                len += snprintf(buf + len, size - len, "&&substr($0,RLENGTH+1,%d)%s\"%-*s\"",
+                                AWK_COMM_WIDTH, awk_ops[t->op], AWK_COMM_WIDTH, t->str);
+            }
+            continue;
+        }
+        if (t->op == FO_CONTAINS || t->op == FO_NOT_CONTAINS) {
+            len += snprintf(buf + len, size - len, "&&index($%d,\"%s\")%s0",
+                            col, t->str, t->op == FO_CONTAINS ? ">" : "==");
+        } else if (fields[fi].is_text) {
+            len += snprintf(buf + len, size - len, "&&$%d%s\"%s\"", col, awk_ops[t->op], t->str);
+        } else if (fields[fi].is_size) { // ps affiche vsz et rss en Ko
+            len += snprintf(buf + len, size - len, "&&$%d*1024%s%.0f", col, awk_ops[t->op], t->num);
+        } else {
+            len += snprintf(buf + len, size - len, "&&$%d%s%g", col, awk_ops[t->op], t->num);
+        }
+    }
+    if (f->count > 0 && len < size) len += snprintf(buf + len, size - len, ")");
+    return (len < size) ? 0 : -1;
+}
+
+const Filter *filter_get_active(void) {
+    return &active_filter;
+}
+
+int filter_set_active(const char *expr, char *err, size_t err_size) {
+    return filter_compile(expr, &active_filter, err, err_size);
+}
@@ -0,0 +1,63 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stddef.h>
+#include "process.h"
+
+#define MAX_FILTER_TERMS 16
+#define MAX_FILTER_VALUE 64
+#define MAX_FILTER_LEN 256
+
+// Étapes de la collecte : un terme est évalué dès que ses données sont lues
+#define FILTER_STAGE_STAT  0   // /proc/<pid>/stat : pid, nom, état, nice, pri, cpu, psr, node
+#define FILTER_STAGE_STATM 1   // /proc/<pid>/statm : mem, rss, virt
+#define FILTER_STAGE_USER  2   // /proc/<pid>/status : user
+#define FILTER_STAGES      3
+
+typedef enum {
+    FF_PID, FF_USER, FF_NAME, FF_STATE, FF_CPU, FF_MEM, FF_RSS, FF_VIRT, FF_NICE, FF_PRI,
+    FF_PSR, FF_NODE
+} FilterField;
+
+typedef enum {
+    FO_EQ, FO_NE, FO_GT, FO_LT, FO_GE, FO_LE,
+    FO_CONTAINS, FO_NOT_CONTAINS   // "~" et "!~" : sous-chaîne
+} FilterOp;
+
+// Un terme compilé "champ op valeur"
+typedef struct {
+    FilterField field;
+    FilterOp op;
+    int stage;
+    double num;                    // valeur numérique (tailles déjà en octets)
+    char str[MAX_FILTER_VALUE];    // valeur texte
+} FilterTerm;
+
+// Programme de filtrage : conjonction de termes
+// Ex: "user=postgres cpu>5 name~java rss>1G"
+typedef struct {
+    int count;
+    int stage_count[FILTER_STAGES];  // nombre de termes par étape (0 : étape sautée)
+    FilterTerm terms[MAX_FILTER_TERMS];
+    char source[MAX_FILTER_LEN];
+} Filter;
+
+// Compile une expression. Retourne 0 si ok, -1 avec un message dans err sinon.
+// Une expression vide donne un filtre qui accepte tout.
+int filter_compile(const char *expr, Filter *f, char *err, size_t err_size);
+
+// Évalue les termes de l'étape donnée. Retourne 1 si le processus est conservé.
+int filter_match(const Filter *f, const ProcessInfo *info, int stage);
+
+// Évalue tous les termes (lignes déjà complètes, ex: hôtes distants)
+int filter_match_all(const Filter *f, const ProcessInfo *info);
+
+// Traduit le filtre en condition awk sur la sortie de ps (colonnes de network.c)
+// pour l'exécuter côté distant. Retourne 0 si ok.
+int filter_to_awk(const Filter *f, char *buf, size_t size);
+
+// Filtre actif, partagé par la collecte locale et distante
+const Filter *filter_get_active(void);
+int filter_set_active(const char *expr, char *err, size_t err_size);
+
+#endif
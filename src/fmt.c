@@ -0,0 +1,143 @@
+#include <string.h>
+#include "fmt.h"
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+int fmt_u64(char *dst, unsigned long long v) {
+    char tmp[24];
+    int pos = sizeof(tmp);
+    // deux chiffres par itération, de droite à gauche
+    while (v >= 100) {
+        unsigned int pair = (unsigned int)(v % 100) * 2;
+        v /= 100;
+        tmp[--pos] = digit_pairs[pair + 1];
+        tmp[--pos] = digit_pairs[pair];
+    }
+    if (v >= 10) {
+        unsigned int pair = (unsigned int)v * 2;
+        tmp[--pos] = digit_pairs[pair + 1];
+        tmp[--pos] = digit_pairs[pair];
+    } else {
+        tmp[--pos] = (char)('0' + v);
+    }
+    int len = sizeof(tmp) - pos;
+    memcpy(dst, tmp + pos, len);
+    return len;
+}
+
+int fmt_i64(char *dst, long long v) {
+    if (v < 0) {
+        dst[0] = '-';
+        return 1 + fmt_u64(dst + 1, 0ULL - (unsigned long long)v);
+    }
+    return fmt_u64(dst, (unsigned long long)v);
+}
+
+static const unsigned long long pow10_table[] = { 1, 10, 100, 1000 };
+
+// Partie entière et partie décimale déjà mises à l'échelle (entier arrondi)
+static int fmt_scaled(char *dst, unsigned long long scaled, int decimals) {
+    unsigned long long scale = pow10_table[decimals];
+    int len = fmt_u64(dst, scaled / scale);
+    if (decimals > 0) {
+        unsigned long long frac = scaled % scale;
+        dst[len++] = '.';
+        for (int d = decimals - 1; d >= 0; d--) {
+            dst[len + d] = (char)('0' + frac % 10);
+            frac /= 10;
+        }
+        len += decimals;
+    }
+    return len;
+}
+
+int fmt_fixed(char *dst, double v, int decimals) {
+    if (decimals < 0) decimals = 0;
+    if (decimals > 3) decimals = 3;
+    int len = 0;
+    if (v < 0) {
+        dst[len++] = '-';
+        v = -v;
+    }
+    unsigned long long scaled = (unsigned long long)(v * pow10_table[decimals] + 0.5);
+    return len + fmt_scaled(dst + len, scaled, decimals);
+}
+
+int fmt_size(char *dst, unsigned long bytes) {
+    static const struct { unsigned long unit; char suffix; } units[] = {
+        { 1024UL * 1024UL * 1024UL, 'G' },
+        { 1024UL * 1024UL, 'M' },
+        { 1024UL, 'K' },
+    };
+    for (int i = 0; i < 3; i++) {
+        if (bytes >= units[i].unit) {
+            // dixièmes arrondis, en arithmétique entière
+            unsigned long long tenths = ((unsigned long long)bytes * 10 + units[i].unit / 2) / units[i].unit;
+            int len = fmt_scaled(dst, tenths, 1);
+            dst[len++] = units[i].suffix;
+            return len;
+        }
+    }
+    int len = fmt_u64(dst, bytes);
+    dst[len++] = 'B';
+    return len;
+}
+
+// Copie une valeur déjà formatée et complète jusqu'à width
+static void lb_put_raw(LineBuf *lb, const char *s, size_t n, int width, int sep) {
+    size_t room = LINEBUF_SIZE - 2 - lb->len; // place pour '\n' et '\0'
+    if (n > room) n = room;
+    memcpy(lb->data + lb->len, s, n);
+    lb->len += n;
+    if ((int)n < width) {
+        size_t pad = width - n;
+        if (pad > LINEBUF_SIZE - 2 - lb->len) pad = LINEBUF_SIZE - 2 - lb->len;
+        memset(lb->data + lb->len, ' ', pad);
+        lb->len += pad;
+    }
+    if (sep && lb->len < LINEBUF_SIZE - 2) lb->data[lb->len++] = ' ';
+}
+
+void lb_put_str(LineBuf *lb, const char *s, int width, int sep) {
+    lb_put_raw(lb, s, strlen(s), width, sep);
+}
+
+void lb_put_char(LineBuf *lb, char c, int width, int sep) {
+    lb_put_raw(lb, &c, 1, width, sep);
+}
+
+void lb_put_int(LineBuf *lb, long long v, int width, int sep) {
+    char tmp[24];
+    lb_put_raw(lb, tmp, fmt_i64(tmp, v), width, sep);
+}
+
+void lb_put_uint(LineBuf *lb, unsigned long long v, int width, int sep) {
+    char tmp[24];
+    lb_put_raw(lb, tmp, fmt_u64(tmp, v), width, sep);
+}
+
+void lb_put_fixed(LineBuf *lb, double v, int decimals, int width, int sep) {
+    char tmp[32];
+    if (v > 1e15 || v < -1e15) v = 0.0; // hors de portée de la virgule fixe
+    lb_put_raw(lb, tmp, fmt_fixed(tmp, v, decimals), width, sep);
+}
+
+void lb_put_size(LineBuf *lb, unsigned long bytes, int width, int sep) {
+    char tmp[32];
+    lb_put_raw(lb, tmp, fmt_size(tmp, bytes), width, sep);
+}
+
+void lb_newline(LineBuf *lb) {
+    lb->data[lb->len++] = '\n';
+    lb->data[lb->len] = '\0';
+}
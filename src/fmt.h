@@ -0,0 +1,38 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stddef.h>
+
+#define LINEBUF_SIZE 1024
+
+// Tampon de ligne : les colonnes y sont écrites bout à bout, puis la ligne
+// est émise en un seul fwrite (pas de printf ni de calcul flottant par champ)
+typedef struct {
+    char data[LINEBUF_SIZE];
+    size_t len;
+} LineBuf;
+
+// Conversion entier -> ASCII par paires de chiffres (table de 200 octets)
+// Retourne le nombre de caractères écrits dans dst (sans '\0')
+int fmt_u64(char *dst, unsigned long long v);
+int fmt_i64(char *dst, long long v);
+
+// Taille lisible, même rendu que format_size() : "512B", "1.5K", "12.0M", "3.2G"
+int fmt_size(char *dst, unsigned long bytes);
+
+// Décimal à virgule fixe : v avec 'decimals' chiffres après la virgule (0 à 3)
+int fmt_fixed(char *dst, double v, int decimals);
+
+static inline void lb_reset(LineBuf *lb) { lb->len = 0; }
+
+// Écrivains de colonnes : valeur alignée à gauche, complétée par des espaces
+// jusqu'à 'width' (comme "%-Ns"), puis un séparateur si sep != 0
+void lb_put_str(LineBuf *lb, const char *s, int width, int sep);
+void lb_put_char(LineBuf *lb, char c, int width, int sep);
+void lb_put_int(LineBuf *lb, long long v, int width, int sep);
+void lb_put_uint(LineBuf *lb, unsigned long long v, int width, int sep);
+void lb_put_fixed(LineBuf *lb, double v, int decimals, int width, int sep);
+void lb_put_size(LineBuf *lb, unsigned long bytes, int width, int sep);
+void lb_newline(LineBuf *lb);
+
+#endif
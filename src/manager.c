@@ -6,11 +6,22 @@
 #include <getopt.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <signal.h>
 #include <time.h>
 #include "manager.h"
 #include "process.h"
+#include "sysstats.h"
+#include "proctree.h"
+#include "filter.h"
+#include "profile.h"
+#include "refresh.h"
 #include "ui.h"
 #include "network.h"
+#include "daemon.h"
+#include "shmexport.h"
+#include "alert.h"
+#include "metrics.h"
+#include "confwatch.h"
 
 // Options pour getopt_long (La même structure complète)
 static struct option long_options[] = {
@@ -25,10 +36,25 @@ static struct option long_options[] = {
     {"username", required_argument, 0, 'u'},
     {"password", required_argument, 0, 'p'},
     {"all", no_argument, 0, 'a'},
+    {"filter", required_argument, 0, 'f'},
+    {"proc-root", required_argument, 0, 'R'}, // option longue uniquement
+    {"cpu-budget", required_argument, 0, 'B'},
+    {"net-budget", required_argument, 0, 'N'},
+    {"daemon", optional_argument, 0, 'D'},
+    {"attach", optional_argument, 0, 'A'},
+    {"export-shm", optional_argument, 0, 'E'},
+    {"io-uring", no_argument, 0, 'U'},
+    {"pid", required_argument, 0, 'W'},
+    {"pidfile", required_argument, 0, 'F'},
+    {"children", no_argument, 0, 'C'},
+    {"alert", required_argument, 0, 'X'},
+    {"alert-file", required_argument, 0, 'Y'},
+    {"alert-log", required_argument, 0, 'Z'},
+    {"export-metrics", required_argument, 0, 'M'},
     {0, 0, 0, 0}
 };
 
-const char *optstring = "hdc:t:P:l:s:u:p:a";
+const char *optstring = "hdc:t:P:l:s:u:p:af:";
 
 
 
@@ -36,13 +62,43 @@ void manager_print_help(void) {
     printf("Usage: my_htop [OPTIONS]\n");
     printf("\nOptions de base:\n");
     printf("  -h, --help                 Affiche l'aide et quitte.\n");
-    printf("  --dry-run                  Test de connexion (local et distant) sans lancer l'interface.\n");
+    printf("  --dry-run                  Test de connexion (local et distant) sans lancer l'interface,\n");
+    printf("                             avec le profil d'une collecte locale (temps par phase, appels système).\n");
     
     printf("\nOptions de configuration des hôtes:\n");
     printf("  -c, --remote-config FILE   Fichier de configuration contenant la liste des machines distantes (droits 600 requis).\n");
+    printf("                             Relu à chaque modification (inotify) : seuls les hôtes ajoutés ou retirés\n");
+    printf("                             sont connectés ou déconnectés, les autres sessions continuent.\n");
     printf("  -s, --remote-server HOST   Adresse IP ou nom DNS de la machine distante à surveiller.\n");
     printf("  -l, --login USER@HOST      Spécifie l'identifiant et la machine distante (Ex: user@server).\n");
     printf("  -a, --all                  Active la collecte des processus sur la machine locale ET les machines distantes (s'utilise avec -c, -s ou -l).\n");
+    printf("  -f, --filter EXPR          N'affiche que les processus correspondant à EXPR (ex: \"user=postgres cpu>5 name~java\").\n");
+    printf("                             Champs: pid user name state cpu mem rss virt nice pri psr node, opérateurs: = != > < >= <= ~ !~\n");
+    printf("  --proc-root DIR            Lit les processus locaux dans DIR au lieu de /proc (copie ou faux /proc).\n");
+    printf("  --cpu-budget PCT           Temps CPU que le moniteur peut consommer, en %% d'un coeur (défaut: %.0f).\n", REFRESH_DEFAULT_CPU_BUDGET);
+    printf("  --net-budget KBPS          Débit réseau que le moniteur peut consommer, en Ko/s (défaut: %.0f).\n", REFRESH_DEFAULT_NET_BUDGET);
+    printf("                             L'intervalle de rafraîchissement (2 s) s'adapte à l'activité dans ces limites.\n");
+    printf("  --daemon[=SOCKET]          Collecte en tâche de fond (local et hôtes configurés) et sert les instantanés\n");
+    printf("                             sur une socket Unix (défaut: $XDG_RUNTIME_DIR/my_htop.sock).\n");
+    printf("  --attach[=SOCKET]          Interface cliente d'un démon : aucune collecte, N interfaces = 1 collecte.\n");
+    printf("  --export-shm[=NAME]        Publie chaque instantané local en mémoire partagée (défaut: %s,\n", SHM_SNAPSHOT_DEFAULT_NAME);
+    printf("                             format décrit dans src/shm_layout.h).\n");
+    printf("  --io-uring                 Lit stat et statm de tous les processus par lots io_uring (noyau >= 5.6),\n");
+    printf("                             avec retour aux lectures classiques si io_uring est indisponible.\n");
+    printf("  --pid PID[,PID...]         Surveille seulement ces processus, sans balayer /proc, toutes les %.0f ms.\n", REFRESH_WATCH_INTERVAL * 1000);
+    printf("  --pidfile FILE             Idem pour le pid lu dans FILE (relu à chaque rafraîchissement, répétable).\n");
+    printf("  --children                 Avec --pid/--pidfile : suit aussi les descendants.\n");
+    printf("  --alert RULE               Règle d'alerte évaluée à chaque collecte (répétable), ex:\n");
+    printf("                             \"cpu>90 for 30s\", \"rss>8G user=app for 1m on local do hook CMD\".\n");
+    printf("                             Condition au format de --filter, puis [for DURÉE] [on any|local|HÔTE]\n");
+    printf("                             [do log|hook CMD|kill|pause|resume|restart]. Lignes concernées en\n");
+    printf("                             surbrillance ; hooks lancés par /bin/sh avec MY_HTOP_PID, _NAME, _HOST...\n");
+    printf("                             Seules les sources collectées sont évaluées : toutes en mode --daemon.\n");
+    printf("  --alert-file FILE          Une règle par ligne (commentaires '#').\n");
+    printf("  --alert-log FILE           Journal des déclenchements (défaut: stdout en mode --daemon).\n");
+    printf("  --export-metrics PORT      Sert GET /metrics (format OpenMetrics) sur 127.0.0.1:PORT : un instantané\n");
+    printf("                             par source collectée, texte préparé à la collecte. Avec --daemon : machine\n");
+    printf("                             locale et tous les hôtes ; sinon la seule source affichée.\n");
     
     printf("\nOptions de connexion détaillées:\n");
     printf("  -u, --username USER        Spécifie le nom d'utilisateur pour la connexion (si non fourni par -l).\n");
@@ -55,7 +111,23 @@ void manager_print_help(void) {
     
     printf("\t<m>       trier par taux d'occupation de la mémoire vive\n");
     printf("\t<p>       trier par taux d'utilisation CPU\n");
+    printf("\t<d>       trier par débit de lecture disque (/proc/<pid>/io, local)\n");
+    printf("\t<w>       trier par débit d'écriture disque (/proc/<pid>/io, local)\n");
+    printf("\t<i>       affiche/masque les colonnes de débit disque RD/s et WR/s\n");
+    printf("\t<s>       affiche/masque les colonnes PSS, USS et SWAP (/proc/<pid>/smaps_rollup, local,\n");
+    printf("\t          lues pour la page affichée puis rafraîchies en tâche de fond toutes les %.0f s)\n", SMAPS_INTERVAL);
+    printf("\t<S>       trier par PSS (valeurs en cache, complétées en tâche de fond)\n");
+    printf("\t<l>       affiche/masque la colonne DLY%% : part du temps passée à attendre un CPU\n");
+    printf("\t          (/proc/<pid>/schedstat du thread principal, local)\n");
+    printf("\t<L>       trier par DLY%%\n");
+    printf("\t<n>       affiche/masque les colonnes PSR (dernier coeur), NODE (son noeud NUMA) et AFFINITY\n");
+    printf("\t          (coeurs autorisés) ; charge par noeud NUMA dans l'en-tête sur une machine multi-noeuds\n");
+    printf("\t<haut/bas>, <j/k>, <PgUp/PgDn>  fait défiler la liste des processus\n");
     printf("\t<r>       passe à la machine suivante (avec l'option -a)\n");
+    printf("\t<t>       vue arborescente (parent -> enfants, cumul CPU/MEM des sous-arbres, local)\n");
+    printf("\t<g>       vue conteneurs : processus regroupés par cgroup (local)\n");
+    printf("\t<H>       mode thread : affiche les threads des processus au-delà de %.0f%% CPU (local)\n", THREAD_CPU_THRESHOLD);
+    printf("\t<D>       pied de page de profilage : temps par phase, fichiers ouverts, octets lus\n");
     printf("\t<c>       ligne de commande : \n");
     printf("\t\thelp, h     affiche les commandes disponibles\n");
     printf("\t\tquit, q     quitte le programme\n");
@@ -63,6 +135,8 @@ void manager_print_help(void) {
     printf("\t\tpause <pid>     met en pause le processus <pid>\n");
     printf("\t\tresume <pid>    relance le processus <pid>\n");
     printf("\t\trestart <pid>   redemarre le processus <pid> si ce dernier le permet\n");
+    printf("\t\tthreads <pid>   affiche/masque les threads du processus <pid> (mode thread)\n");
+    printf("\t\tfilter <expr>   filtre les processus (même syntaxe que --filter, sans expr : supprime le filtre)\n");
     printf("\n");
 }
 
@@ -107,26 +181,181 @@ void parse_config_file(const char *path, ManagerConfig *cfg) {
     fclose(f);
 }
 
-//fonction gestion du rafraichissement
-//Chronomètre :
-// Mémorise l'heure de départ
-void stopwatch_init(time_t *lasttime) {
-    *lasttime = time(NULL);
+// Signaux des règles d'alerte : kill() en local, la session ssh de l'hôte sinon
+static ssh_session *alert_sessions = NULL;
+
+static int alert_send_signal(int source, int pid, int sig) {
+    if (source < 0) return kill(pid, sig);
+    if (!alert_sessions || !alert_sessions[source]) return -1;
+    return network_send_signal(alert_sessions[source], pid, sig);
 }
 
-// Refresh si on a atteint le temps de refresh demandé
-int refresh_check(time_t *lasttime, int sec_interval){
-    time_t cur_time = time(NULL);
-    if (difftime(cur_time, *lasttime) >= sec_interval){
-        *lasttime = cur_time; //replacing latest refresh date
-        return 1; //we refresh
-    }else{
-        return 0; //too soon
-    }
+// Activité d'un hôte distant (0..1) d'après le %CPU rapporté par ps
+static double rows_activity(const ProcessInfo rows[], int count) {
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += rows[i].cpu_percent;
+    return (sum > 100.0) ? 1.0 : sum / 100.0;
 }
 
 
 // --- Fonction Principale ---
+// Profil d'une collecte locale complète, sans affichage du terminal :
+// deux passes (la première ouvre les descripteurs, la seconde est le régime établi)
+static void manager_dry_run_profile(void) {
+    static PidTable table;
+    static ProcessInfo procs[MAX_PROCESSES];
+    static SystemStats stats;
+    LineBuf lb;
+
+    process_initial_scan(&table);
+    sysstats_update(&stats);
+    unsigned long long prev_total = sysstats_cpu_total(&stats.total);
+    for (int pass = 0; pass < 2; pass++) {
+        prof_frame_begin("local");
+        prof_start(PROF_SYSSTATS);
+        sysstats_update(&stats);
+        unsigned long long curr_total = sysstats_cpu_total(&stats.total);
+        prof_stop(PROF_SYSSTATS);
+        prof_start(PROF_COLLECT);
+        int count = process_collect_all(procs, MAX_PROCESSES, prev_total, &table, curr_total, COLLECT_FIELDS);
+        prof_stop(PROF_COLLECT);
+        prof_start(PROF_SORT);
+        process_sort(procs, count, SORT_CPU);
+        prof_stop(PROF_SORT);
+        prof_start(PROF_RENDER); // formatage seul, les lignes ne sont pas écrites
+        for (int i = 0; i < count; i++) {
+            lb_reset(&lb);
+            ui_format_process(&lb, &procs[i], 0, "");
+        }
+        prof_stop(PROF_RENDER);
+        prev_total = curr_total;
+        prof_frame_end();
+        printf("[DRY-RUN] Profil passe %d (%d processus):\n", pass + 1, count);
+        ui_print_profile(prof_last_frame());
+        printf("\n");
+    }
+    pidtable_free(&table);
+}
+
+// Interface cliente d'un démon (--attach) : les instantanés sont demandés
+// au démon, seuls le filtre, le tri et le rendu sont faits ici. Les vues qui
+// lisent /proc (arbre, threads, cgroups, I/O) restent propres au mode normal.
+static void manager_run_client(ManagerConfig *cfg) {
+    int fd = daemon_connect(cfg->socket_path);
+    if (fd < 0) {
+        fprintf(stderr, "Aucun démon sur %s (lancer my_htop --daemon)\n", cfg->socket_path);
+        exit(EXIT_FAILURE);
+    }
+    static ProcessInfo rows[MAX_PROCESSES];
+    static SystemStats stats;
+    DaemonReply reply;
+    SortMode current_mode = SORT_CPU;
+    uint64_t last_seq = 0;
+    int source = 0, count = 0, has_stats = 0, profile_mode = 0, numa_columns = 0;
+    int force_refresh = 1;
+    double last_poll = 0;
+
+    ui_init();
+    term_init();
+    while (1) {
+        term_toggle(1);
+        if (!keyhit_check()) {
+            double now = refresh_now();
+            if (ui_resized()) force_refresh = 1;
+            // interrogation peu coûteuse : le démon répond "inchangé" sans données
+            if (!force_refresh && now - last_poll < REFRESH_MIN_INTERVAL) {
+                nanosleep(&(struct timespec){0,10000000},NULL);
+                continue;
+            }
+            last_poll = now;
+            prof_frame_begin("démon");
+            int n = daemon_fetch(fd, source, force_refresh ? 0 : last_seq, &reply, &stats, rows, MAX_PROCESSES);
+            if (n < 0) {
+                term_toggle(0);
+                fprintf(stderr, "\nConnexion au démon perdue\n");
+                exit(EXIT_FAILURE);
+            }
+            if (reply.status == DAEMON_UNCHANGED && !force_refresh) continue;
+            force_refresh = 0;
+            if (reply.status == DAEMON_OK) {
+                last_seq = reply.seq;
+                has_stats = reply.has_stats;
+                // filtre local en plus de celui du démon
+                const Filter *filter = filter_get_active();
+                count = 0;
+                for (int i = 0; i < n; i++) {
+                    if (filter_match_all(filter, &rows[i])) rows[count++] = rows[i];
+                }
+            }
+            prof_start(PROF_SORT);
+            process_sort_top(rows, count, current_mode, ui_rows_needed());
+            prof_stop(PROF_SORT);
+
+            prof_start(PROF_RENDER);
+            char title[DAEMON_NAME_LEN + 48];
+            const char *name = (source < reply.nsources) ? reply.names[source] : "?";
+            snprintf(title, sizeof(title), " [ DÉMON: %s (%d/%d) ]", name, source + 1, reply.nsources);
+            ui_begin_frame(title);
+            if (reply.status == DAEMON_NO_SOURCE) {
+                printf("En attente de la première collecte...\n");
+            } else {
+                if (has_stats) ui_print_meters(&stats);
+                ui_set_io_columns(0);
+                ui_set_smaps_columns(0);
+                ui_set_delay_column(0);
+                ui_set_numa_columns(numa_columns); // lignes complètes : le démon lit status pour tous
+                ui_refresh_process_list(rows, count, 0);
+            }
+            prof_stop(PROF_RENDER);
+            prof_frame_end();
+        } else {
+            char pressed = getchar();
+            force_refresh = 1;
+            switch (pressed) {
+                case 27: {
+                    if (!keyhit_check() || getchar() != '[' || !keyhit_check()) break;
+                    char code = getchar();
+                    if (code == 'A') ui_scroll(-1);
+                    else if (code == 'B') ui_scroll(1);
+                    else if ((code == '5' || code == '6') && keyhit_check() && getchar() == '~')
+                        ui_scroll_pages(code == '5' ? -1 : 1);
+                    break;
+                }
+                case 'k': ui_scroll(-1); break;
+                case 'j': ui_scroll(1); break;
+                case 'm': current_mode = SORT_MEM; break;
+                case 'p': current_mode = SORT_CPU; break;
+                case 'n': numa_columns = !numa_columns; break;
+                case 'D':
+                    profile_mode = !profile_mode;
+                    ui_set_profile_footer(profile_mode);
+                    break;
+                case 'r':
+                    source = (reply.nsources > 0) ? (source + 1) % reply.nsources : 0;
+                    last_seq = 0;
+                    count = 0;
+                    break;
+                case 'q':
+                    close(fd);
+                    exit(0);
+                case 'c': {
+                    term_toggle(0);
+                    char user_command[256];
+                    printf(" > ");
+                    if (!fgets(user_command, sizeof(user_command), stdin)) break;
+                    if (has_stats) { // source locale : les signaux partent d'ici
+                        command_handling(user_command);
+                    } else {
+                        printf("Commandes distantes indisponibles en mode --attach\n");
+                        sleep(1);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
 void manager_run(int argc, char *argv[]) {
     ManagerConfig config = {0};
     
@@ -144,6 +373,79 @@ void manager_run(int argc, char *argv[]) {
             case 'h': config.show_help = 1; break;
             case 'd': config.dry_run = 1; break;
             case 'a': option_all = 1; break;
+            case 'f': {
+                char err[128];
+                if (filter_set_active(optarg, err, sizeof(err)) != 0) {
+                    fprintf(stderr, "Filtre invalide: %s\n", err);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'R':
+                if (strlen(optarg) >= PROC_ROOT_MAX) {
+                    fprintf(stderr, "Chemin trop long pour --proc-root (max %d)\n", PROC_ROOT_MAX - 1);
+                    exit(EXIT_FAILURE);
+                }
+                process_set_proc_root(optarg);
+                break;
+            case 'D':
+            case 'A':
+                if (opt == 'D') config.daemon_mode = 1;
+                else config.attach_mode = 1;
+                if (optarg) strncpy(config.socket_path, optarg, MAX_PATH_LEN - 1);
+                break;
+            case 'E':
+                strncpy(config.shm_name, optarg ? optarg : SHM_SNAPSHOT_DEFAULT_NAME, sizeof(config.shm_name) - 1);
+                break;
+            case 'U':
+                if (!process_set_io_uring(1)) {
+                    fprintf(stderr, "io_uring indisponible, lectures classiques de /proc\n");
+                }
+                break;
+            case 'W': {
+                char *p = optarg;
+                while (*p) {
+                    char *end;
+                    long pid = strtol(p, &end, 10);
+                    if (end == p || pid <= 0 || (*end != ',' && *end != '\0') || process_watch_pid((int)pid) != 0) {
+                        fprintf(stderr, "Liste de pids invalide ou trop longue (max %d): %s\n", MAX_WATCH, optarg);
+                        exit(EXIT_FAILURE);
+                    }
+                    p = (*end == ',') ? end + 1 : end;
+                }
+                break;
+            }
+            case 'F':
+                if (process_watch_pidfile(optarg) != 0) {
+                    fprintf(stderr, "Trop de fichiers de pid ou chemin trop long: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'C': process_watch_descendants(1); break;
+            case 'X':
+            case 'Y': {
+                char err[256];
+                int rc = (opt == 'X') ? alert_add_rule(optarg, err, sizeof(err))
+                                      : alert_load_file(optarg, err, sizeof(err));
+                if (rc != 0) {
+                    fprintf(stderr, "Règle d'alerte invalide: %s\n", err);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'Z': strncpy(config.alert_log, optarg, MAX_PATH_LEN - 1); break;
+            case 'M': config.metrics_port = atoi(optarg); break;
+            case 'B':
+            case 'N': {
+                double value = atof(optarg);
+                if (value <= 0) {
+                    fprintf(stderr, "Budget invalide: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                if (opt == 'B') refresh_set_budget(value, 0);
+                else refresh_set_budget(0, value);
+                break;
+            }
             case 'c': strncpy(config.cli_config_file, optarg, MAX_PATH_LEN - 1); break;
             //case 't': strncpy(config.cli_host.connection_type, optarg, 9); break;
             case 'P': config.cli_host.port = atoi(optarg); break;
@@ -179,6 +481,12 @@ void manager_run(int argc, char *argv[]) {
         return;
     }
 
+    if (config.socket_path[0] == '\0') daemon_default_path(config.socket_path, MAX_PATH_LEN);
+    if (config.attach_mode) { // le démon a déjà les hôtes : pas de configuration à lire
+        manager_run_client(&config);
+        return;
+    }
+
     // --- LOGIQUE DE PRÉ-EXÉCUTION ---
 
     // 2. Gestion du fichier de configuration (-c ou .config)
@@ -232,7 +540,19 @@ void manager_run(int argc, char *argv[]) {
 
     if (config.dry_run) {
         printf("[DRY-RUN] Démarrage...\n");
-        if (config.collect_local) printf("[DRY-RUN] Accès Local: OK\n");
+        if (config.collect_local) {
+            printf("[DRY-RUN] Accès Local: OK\n");
+            manager_dry_run_profile();
+        }
+        for (int i = 0; i < alert_rule_count(); i++) {
+            printf("[DRY-RUN] Règle d'alerte %d: %s\n", i + 1, alert_rule(i)->text);
+        }
+        if (filter_get_active()->count > 0) {
+            char awk_cond[MAX_FILTER_LEN * 4];
+            printf("[DRY-RUN] Filtre: %s\n", filter_get_active()->source);
+            if (filter_to_awk(filter_get_active(), awk_cond, sizeof(awk_cond)) == 0)
+                printf("[DRY-RUN] Filtre distant (awk): %s\n", awk_cond);
+        }
         
         for(int i=0; i<config.host_count; i++) {
             printf("[DRY-RUN] Test connexion vers %s (%s@%s:%d)... SIMULATION OK\n", 
@@ -244,26 +564,83 @@ void manager_run(int argc, char *argv[]) {
         return; // Arrêt
     }
 
+    if (alert_rule_count() > 0) {
+        if (config.alert_log[0] != '\0') {
+            FILE *log = fopen(config.alert_log, "a");
+            if (!log) {
+                perror(config.alert_log);
+                exit(EXIT_FAILURE);
+            }
+            alert_set_log(log);
+        } else if (config.daemon_mode) {
+            alert_set_log(stdout);
+        }
+        alert_set_signal_handler(alert_send_signal);
+    }
+
+    if (config.shm_name[0] != '\0' && config.collect_local) {
+        if (shmexport_open(config.shm_name) != 0) exit(EXIT_FAILURE);
+        atexit(shmexport_close); // la région disparaît avec le processus qui publie
+    }
+    if (config.metrics_port != 0 && !config.attach_mode) {
+        if (metrics_open(config.metrics_port) != 0) exit(EXIT_FAILURE);
+        atexit(metrics_close);
+    }
+    // fichier d'hôtes relu à chaque modification (même s'il n'existe pas encore)
+    if (config_path && !config.attach_mode && confwatch_open(config_path) != 0) {
+        fprintf(stderr, "inotify indisponible : %s ne sera pas rechargé\n", config_path);
+    }
+
     // --- Boucle Principale ---
     
     // Initialisation UI
-    //ui_init(); ncurses 
+    ui_init(); // taille du terminal et SIGWINCH
     
 
     // Initialisation des états (variables statiques et tableaux)
     ProcessInfo local_procs[MAX_PROCESSES];
-    static unsigned long prev_times[MAX_PID] = {0};
+    static PidTable local_table;   // état par pid (temps CPU précédent, descripteurs en cache)
+    static PidTable thread_table;  // idem pour les threads en mode thread
+    static ProcessInfo display_rows[MAX_DISPLAY_ROWS];
+    static ProcessInfo tree_rows[MAX_PROCESSES];
+    int thread_mode = 0;
+    int tree_mode = 0;
+    int io_columns = 0;
+    int cgroup_mode = 0;
+    int profile_mode = 0;
+    int smaps_columns = 0;
+    int delay_column = 0;
+    int numa_columns = 0;
+    ProcessInfo *shown_rows = NULL; // dernière liste locale affichée (rafraîchissement smaps en tâche de fond)
+    int shown_count = 0;
+    // dernière liste dessinée (locale ou distante) : le défilement la redessine
+    // sans nouvelle collecte. partial : seules les premières lignes sont triées
+    ProcessInfo *view_rows = NULL;
+    int view_count = 0;
+    int view_partial = 0;
+    int view_meters = 0;
+    char view_title[MAX_NAME_LEN + 16] = "";
+    int redraw = 0;
+    int metrics_source = -2; // source publiée dans l'export OpenMetrics (-2 : aucune)
+    static CgroupStats cgroups[MAX_CGROUPS];
     unsigned long long prev_total_cpu = 0;
     int is_first = 1;
+    static SystemStats sys_stats; // en-tête système (local uniquement)
 
     if (config.collect_local) {
-        process_initial_scan(prev_times);
-        prev_total_cpu = process_get_total_cpu_time();
+        process_initial_scan(&local_table);
+        sysstats_update(&sys_stats);
+        prev_total_cpu = sysstats_cpu_total(&sys_stats.total);
     }
 
-    //initialisation de la stopwatch
-    time_t *last_time = malloc(sizeof(time_t));
-    stopwatch_init(last_time);
+    // ordonnancement adaptatif : un état par source (machine locale, puis chaque hôte)
+    static RefreshState refresh_local;
+    static RefreshState refresh_hosts[MAX_HOSTS];
+    refresh_init(&refresh_local);
+    if (process_watch_active()) refresh_set_fixed(&refresh_local, REFRESH_WATCH_INTERVAL); // quelques pids : trame haute fréquence
+    for (int i = 0; i < MAX_HOSTS; i++) refresh_init(&refresh_hosts[i]);
+    refresh_set_sources(1); // seule la source affichée est collectée
+    int force_refresh = 0;  // touche ou redimensionnement : on redessine tout de suite
 
     //initialisation intercepteur de clavier
     term_init();
@@ -300,6 +677,7 @@ void manager_run(int argc, char *argv[]) {
             }
         }   
     }
+    alert_sessions = remote_sessions;
     if (active_rem_hosts == 0 && !config.collect_local) {
         fprintf(stderr, "\nAucune connexion active - presser une touche pour quitter \n");
         getchar();
@@ -309,41 +687,179 @@ void manager_run(int argc, char *argv[]) {
         sleep(2);   //si une connexion ssh a échoué, l'utilisateur a le temps de lire l'erreur avant que le programme ne poursuive
     }
 
+    if (config.daemon_mode) {
+        ui_cleanup();
+        int rc = daemon_run(&config, remote_sessions, config.socket_path);
+        for (int i = 0; i < config.host_count; i++) {
+            if (config.hosts[i].enabled) network_disconnect(remote_sessions[i]);
+        }
+        if (rc != 0) exit(EXIT_FAILURE);
+        return;
+    }
+
     
     while (1) {
         //entrée dans la boucle -> passage clavier mode RAW
         term_toggle(1);
         //vérification du buffer keyhit_check() - 0 = vide / 1 = non-vide
         if(!keyhit_check()){
-            if(is_first || refresh_check(last_time,2)){
+            if (ui_resized()) force_refresh = 1;
+            int moved_from[MAX_HOSTS];
+            if (confwatch_changed() && confwatch_reload(&config, remote_sessions, moved_from) >= 0) {
+                // l'état de rafraîchissement suit son hôte, la source affichée aussi
+                RefreshState kept[MAX_HOSTS];
+                int shown = display_source;
+                display_source = config.collect_local ? -1 : 0;
+                for (int i = 0; i < MAX_HOSTS; i++) {
+                    if (moved_from[i] >= 0) kept[i] = refresh_hosts[moved_from[i]];
+                    else refresh_init(&kept[i]);
+                    if (shown >= 0 && moved_from[i] == shown) display_source = i;
+                }
+                memcpy(refresh_hosts, kept, sizeof(kept));
+                if (!config.collect_local && config.host_count == 0) {
+                    // plus aucun hôte : machine locale, comme au démarrage sans configuration
+                    config.collect_local = 1;
+                    process_initial_scan(&local_table);
+                    sysstats_update(&sys_stats);
+                    prev_total_cpu = sysstats_cpu_total(&sys_stats.total);
+                    display_source = -1;
+                }
+                force_refresh = 1;
+            }
+            RefreshState *rs = (display_source < 0) ? &refresh_local : &refresh_hosts[display_source];
+            double now = refresh_now();
+            if(is_first || force_refresh || refresh_due(rs, now)){
                 int count = 0;
+                force_refresh = 0;
+                redraw = 0;
+                view_rows = NULL;
+                // hors démon, seule la source affichée est collectée : l'export ne
+                // garde qu'elle, une autre serait servie figée comme si elle était à jour
+                if (metrics_source != display_source) {
+                    if (metrics_source >= -1) metrics_drop_source(metrics_source);
+                    metrics_source = display_source;
+                }
+                double cpu_start = refresh_cpu_time();
                 // Collecte Locale
                 if (config.collect_local && display_source==-1) {
-                    unsigned long long curr_total = process_get_total_cpu_time();
-                    count = process_collect_all(local_procs, MAX_PROCESSES, prev_total_cpu, prev_times, curr_total);
-                    process_sort(local_procs, count, current_mode);
+                    prof_frame_begin("local");
+                    prof_start(PROF_SYSSTATS);
+                    sysstats_update(&sys_stats); // une seule lecture de /proc/stat, meminfo et loadavg
+                    unsigned long long curr_total = sysstats_cpu_total(&sys_stats.total);
+                    prof_stop(PROF_SYSSTATS);
+                    // /proc/<pid>/io n'est lu que si les colonnes sont affichées ou servent au tri
+                    int flags = 0;
+                    if (io_columns || current_mode == SORT_IO_READ || current_mode == SORT_IO_WRITE) flags |= COLLECT_IO;
+                    if (cgroup_mode) flags |= COLLECT_CGROUP;
+                    // USER et la mémoire ne sont lus pour tous que si le tri, la vue ou
+                    // l'export les utilisent, sinon seulement pour la page affichée
+                    if (current_mode == SORT_MEM || tree_mode || cgroup_mode) flags |= COLLECT_MEM;
+                    if (config.shm_name[0] != '\0' || metrics_active()) flags |= COLLECT_FIELDS;
+                    // PSS/USS/SWAP : recopiés du cache, lus pour la page et en tâche de fond
+                    if (smaps_columns || current_mode == SORT_PSS) flags |= COLLECT_SMAPS;
+                    flags |= alert_collect_flags(); // champs testés par les règles, pour tous les pids
+                    // schedstat est relu avec stat, dans la même passe
+                    if (delay_column || current_mode == SORT_DELAY) flags |= COLLECT_SCHED;
+                    ui_set_io_columns(flags & COLLECT_IO);
+                    ui_set_smaps_columns(smaps_columns);
+                    ui_set_delay_column(flags & COLLECT_SCHED);
+                    // coeur et noeud viennent de stat, l'affinité de status (lu pour la page)
+                    ui_set_numa_columns(numa_columns);
+                    prof_start(PROF_COLLECT);
+                    count = process_collect_all(local_procs, MAX_PROCESSES, prev_total_cpu, &local_table, curr_total, flags);
+                    prof_stop(PROF_COLLECT);
+                    int collected = count;
+                    alert_evaluate(-1, "local", local_procs, count);
+                    shmexport_publish(local_procs, count, &sys_stats);
+                    metrics_publish(-1, "local", local_procs, count, &sys_stats);
+                    // arbre et threads réordonnent toute la liste : tri complet
+                    prof_start(PROF_SORT);
+                    process_sort_top(local_procs, count, current_mode,
+                                     (tree_mode || thread_mode || cgroup_mode) ? 0 : ui_rows_needed());
+                    prof_stop(PROF_SORT);
+                    ProcessInfo *rows = local_procs;
+                    int ngroups = 0;
+                    prof_start(PROF_VIEW);
+                    if (cgroup_mode) {
+                        // agrégation par cgroup en une passe, les vues arbre/thread ne s'appliquent pas
+                        ngroups = cgroup_aggregate(local_procs, count, cgroups, MAX_CGROUPS, 1);
+                    } else {
+                        if (tree_mode) {
+                            count = proctree_build(rows, count, tree_rows, MAX_PROCESSES, &local_table);
+                            rows = tree_rows;
+                        }
+                        if (thread_mode) {
+                            count = process_expand_threads(rows, count, display_rows, MAX_DISPLAY_ROWS,
+                                                           &thread_table, prev_total_cpu, curr_total, flags);
+                            rows = display_rows;
+                        }
+                    }
+                    if ((flags & COLLECT_SMAPS) && !cgroup_mode) {
+                        int lo, hi;
+                        ui_page_window(count, &lo, &hi);
+                        process_smaps_update(&local_table, rows + lo, hi - lo, 1, SMAPS_PAGE_BUDGET_MS);
+                    }
+                    prof_stop(PROF_VIEW);
+                    shown_rows = cgroup_mode ? NULL : rows;
+                    shown_count = count;
+                    view_rows = shown_rows;
+                    view_count = count;
+                    view_partial = !(tree_mode || thread_mode);
+                    view_meters = 1;
+                    snprintf(view_title, sizeof(view_title), "%s", config.collect_remote ? "[ LOCAL ]" : "");
                     prev_total_cpu = curr_total;
-                    system("clear"); 
-                    if(config.collect_remote) printf("[ LOCAL ]\n");
-                    ui_refresh_process_list(local_procs, count, is_first);
+                    prof_start(PROF_RENDER);
+                    ui_begin_frame(config.collect_remote ? "[ LOCAL ]" : NULL);
+                    ui_print_meters(&sys_stats);
+                    if (cgroup_mode) {
+                        ui_print_cgroups(cgroups, ngroups);
+                    } else {
+                        ui_refresh_process_list(rows, count, is_first);
+                    }
+                    prof_stop(PROF_RENDER);
+                    prof_frame_end();
+                    refresh_record(rs, now, refresh_cpu_time() - cpu_start, 0,
+                                   sys_stats.total_percent / 100.0, collected, 1);
                 }
         
             // Collecte Distante 
                 if (config.collect_remote && display_source>=0 && display_source<config.host_count){ //remote seule 
+                    shown_rows = NULL;
                     if (config.hosts[display_source].enabled) {
-                        ProcessInfo remote_procs[MAX_PROCESSES];
+                        static ProcessInfo remote_procs[MAX_PROCESSES]; // gardé pour le défilement
+                        prof_frame_begin(config.hosts[display_source].display_name);
                         int r_count = network_collect(remote_sessions[display_source], remote_procs, MAX_PROCESSES);
                         
                         if (r_count > 0) {
-                            process_sort(remote_procs, r_count, current_mode);
+                            alert_evaluate(display_source, config.hosts[display_source].display_name, remote_procs, r_count);
+                            metrics_publish(display_source, config.hosts[display_source].display_name,
+                                            remote_procs, r_count, NULL);
+                            prof_start(PROF_SORT);
+                            process_sort_top(remote_procs, r_count, current_mode, ui_rows_needed());
+                            prof_stop(PROF_SORT);
+                            prof_start(PROF_RENDER);
                             
                             // Display Header for Remote
-                            system("clear");
-                            printf(" [ REMOTE: %s ]\n", config.hosts[display_source].display_name);
+                            char title[MAX_NAME_LEN + 16];
+                            snprintf(title, sizeof(title), " [ REMOTE: %s ]", config.hosts[display_source].display_name);
+                            ui_begin_frame(title);
+                            ui_set_io_columns(io_columns); // ps ne fournit pas les débits : colonnes à "-"
+                            ui_set_smaps_columns(smaps_columns);
+                            ui_set_delay_column(delay_column);
+                            ui_set_numa_columns(numa_columns); // psr seul : noeud et affinité à "-"
                             ui_refresh_process_list(remote_procs, r_count, is_first);
+                            prof_stop(PROF_RENDER);
+                            view_rows = remote_procs;
+                            view_count = r_count;
+                            view_partial = 1;
+                            view_meters = 0;
+                            snprintf(view_title, sizeof(view_title), "%s", title);
                         } else {
                            printf("Waiting for data from %s...\n", config.hosts[display_source].display_name);
                         }
+                        prof_frame_end();
+                        refresh_record(rs, now, refresh_cpu_time() - cpu_start, prof_last_frame()->counters.bytes_read,
+                                       rows_activity(remote_procs, r_count), r_count, 1);
                     } else {
                         printf("Host %s is disconnected.\n", config.hosts[display_source].display_name);
                     }
@@ -361,6 +877,23 @@ void manager_run(int argc, char *argv[]) {
 
             // for(int i=0; i<config.host_count; i++) { network_collect(&config.hosts[i]); }
             }else{
+                // défilement : la page est redessinée depuis la dernière collecte,
+                // en triant de nouvelles lignes si la liste n'est triée qu'en tête
+                if (redraw && view_rows) {
+                    if (view_partial) process_sort_top(view_rows, view_count, current_mode, ui_rows_needed());
+                    ui_begin_frame(view_title[0] ? view_title : NULL);
+                    if (view_meters) ui_print_meters(&sys_stats);
+                    ui_refresh_process_list(view_rows, view_count, 0);
+                }
+                redraw = 0;
+                // entre deux trames : une tranche de relectures smaps_rollup périmées
+                // (toute la liste pour le tri PSS, sinon la page affichée)
+                if (shown_rows && (smaps_columns || current_mode == SORT_PSS)) {
+                    int lo = 0, hi = shown_count;
+                    if (current_mode != SORT_PSS) ui_page_window(shown_count, &lo, &hi);
+                    process_smaps_update(&local_table, shown_rows + lo, hi - lo, 0, SMAPS_IDLE_BUDGET_MS);
+                }
+                metrics_serve(); // réponses déjà prêtes : un envoi par requête
                 //cpu protection : we prevent the loop from running at full throttle 
                 nanosleep(&(struct timespec){0,10000000},NULL);
             }
@@ -370,14 +903,87 @@ void manager_run(int argc, char *argv[]) {
             char pressed = getchar();
             
             switch(pressed){
+                case 27: { // séquences d'échappement : flèches, PgUp/PgDn
+                    if (!keyhit_check() || getchar() != '[' || !keyhit_check()) break;
+                    char code = getchar();
+                    if (code == 'A') ui_scroll(-1);
+                    else if (code == 'B') ui_scroll(1);
+                    else if ((code == '5' || code == '6') && keyhit_check() && getchar() == '~')
+                        ui_scroll_pages(code == '5' ? -1 : 1);
+                    redraw = 1;
+                    break;
+                }
+                case 'k': { ui_scroll(-1); redraw = 1; break; }
+                case 'j': { ui_scroll(1); redraw = 1; break; }
                 case 'm': {
                     current_mode = SORT_MEM;
-                    *last_time = 0;
+                    force_refresh = 1;
                     break;
                 }
                 case 'p':{
                     current_mode = SORT_CPU;
-                    *last_time = 0;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'i':{
+                    io_columns = !io_columns;
+                    force_refresh = 1;
+                    break;
+                }
+                case 's':{
+                    smaps_columns = !smaps_columns;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'S':{
+                    current_mode = SORT_PSS;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'l':{
+                    delay_column = !delay_column;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'L':{
+                    current_mode = SORT_DELAY;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'n':{
+                    numa_columns = !numa_columns;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'd':{
+                    current_mode = SORT_IO_READ;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'w':{
+                    current_mode = SORT_IO_WRITE;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'g':{
+                    cgroup_mode = !cgroup_mode;
+                    force_refresh = 1;
+                    break;
+                }
+                case 't':{
+                    tree_mode = !tree_mode;
+                    force_refresh = 1;
+                    break;
+                }
+                case 'D':{
+                    profile_mode = !profile_mode;
+                    ui_set_profile_footer(profile_mode);
+                    force_refresh = 1;
+                    break;
+                }
+                case 'H':{
+                    thread_mode = !thread_mode;
+                    force_refresh = 1;
                     break;
                 }
                 case 'r':{
@@ -385,7 +991,7 @@ void manager_run(int argc, char *argv[]) {
                     if(display_source>=config.host_count){
                         display_source = (config.collect_local) ? -1 : 0;
                     }
-                    *last_time=0; //réinitialise last_time pour déclencher le rafraîchissement
+                    force_refresh = 1; //déclenche le rafraîchissement de la nouvelle source
                     break;
                 }
                 case 'q': {
@@ -3,6 +3,7 @@
 #define MANAGER_H
 
 #include <stddef.h>
+#include <time.h>
 
 // --- Constantes Générales ---
 #define MAX_HOSTS 10
@@ -39,6 +40,15 @@ typedef struct {
     char cli_config_file[MAX_PATH_LEN];
     RemoteHost cli_host; // Pour stocker temporairement les infos de -s, -l, -u, -p
     int cli_host_defined; // Flag pour savoir si -s ou -l a été utilisé
+
+    // Mode démon (--daemon) ou client d'un démon (--attach)
+    int daemon_mode;
+    int attach_mode;
+    char socket_path[MAX_PATH_LEN];
+
+    char shm_name[64]; // --export-shm : nom de la région ("" : pas d'export)
+    char alert_log[MAX_PATH_LEN]; // --alert-log : journal des alertes ("" : aucun, stdout en mode démon)
+    int metrics_port; // --export-metrics : port HTTP OpenMetrics sur 127.0.0.1 (0 : pas d'export)
 } ManagerConfig;
 
 
@@ -51,7 +61,4 @@ void manager_ask_input(const char *prompt, char *buffer, size_t size);
 int check_file_permissions(const char *path);
 void parse_config_file(const char *path, ManagerConfig *cfg);
 
-void stopwatch_init(time_t *lasttime);
-int refresh_check(time_t *lasttime, int sec_interval);
-
 #endif
\ No newline at end of file
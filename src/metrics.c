@@ -0,0 +1,430 @@
+#define _GNU_SOURCE // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "metrics.h"
+#include "fmt.h"
+#include "refresh.h"
+
+// Tampon de texte extensible, réutilisé d'une collecte à l'autre
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} TextBuf;
+
+// Familles de métriques, dans l'ordre du corps servi
+enum {
+    M_HOST_CPU, M_HOST_MEM_TOTAL, M_HOST_MEM_AVAILABLE, M_HOST_LOAD, M_HOST_PRESSURE,
+    M_HOST_PROCESSES, M_HOST_COLLECTED,
+    M_PROC_CPU, M_PROC_CPU_SECONDS, M_PROC_RES, M_PROC_VIRT, M_PROC_THREADS,
+    M_PROC_DELAY, M_PROC_ALERT,
+    M_NFAMILIES
+};
+
+static const struct { const char *name; const char *type; const char *help; } families[M_NFAMILIES] = {
+    { "myhtop_host_cpu_percent", "gauge", "Utilisation CPU de la machine (100 = tous les coeurs)" },
+    { "myhtop_host_memory_total_bytes", "gauge", "MemTotal" },
+    { "myhtop_host_memory_available_bytes", "gauge", "MemAvailable" },
+    { "myhtop_host_load_average", "gauge", "Charge moyenne sur 1, 5 et 15 minutes" },
+    { "myhtop_host_pressure_avg10_percent", "gauge", "Pression PSI sur 10 s (/proc/pressure)" },
+    { "myhtop_host_processes", "gauge", "Processus dans l'instantané" },
+    { "myhtop_host_collected_timestamp_seconds", "gauge", "Heure de la collecte (epoch)" },
+    { "myhtop_process_cpu_percent", "gauge", "CPU du processus (100 = toute la machine en local, un coeur à distance)" },
+    { "myhtop_process_cpu_seconds", "counter", "Temps CPU cumulé (utime+stime)" },
+    { "myhtop_process_resident_memory_bytes", "gauge", "RES" },
+    { "myhtop_process_virtual_memory_bytes", "gauge", "VIRT" },
+    { "myhtop_process_threads", "gauge", "Nombre de threads" },
+    { "myhtop_process_run_delay_percent", "gauge", "Part du temps passée à attendre un CPU (schedstat)" },
+    { "myhtop_process_alert_state", "gauge", "Règle d'alerte vérifiée : 1 en attente, 2 déclenchée" },
+};
+
+// Segments par source : texte des échantillons de chaque famille
+typedef struct {
+    int used;
+    TextBuf fam[M_NFAMILIES];
+} MetricsSource;
+
+static MetricsSource sources[METRICS_MAX_SOURCES];
+static TextBuf body;                 // corps servi, reconstruit à chaque publication
+static char head[256];               // en-tête HTTP du corps courant
+static int head_len = 0;
+static int listen_fd = -1;
+
+// ----------- écriture du texte -----------------
+
+static int tb_reserve(TextBuf *b, size_t extra) {
+    if (b->len + extra <= b->cap) return 1;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + extra) cap *= 2;
+    char *p = realloc(b->data, cap);
+    if (!p) return 0;
+    b->data = p;
+    b->cap = cap;
+    return 1;
+}
+
+static void tb_put(TextBuf *b, const char *s, size_t n) {
+    if (!tb_reserve(b, n)) return;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+static void tb_str(TextBuf *b, const char *s) {
+    tb_put(b, s, strlen(s));
+}
+
+// Valeur de label : \, " et saut de ligne échappés
+static void tb_label_value(TextBuf *b, const char *s) {
+    for (; *s; s++) {
+        if (*s == '\\') tb_put(b, "\\\\", 2);
+        else if (*s == '"') tb_put(b, "\\\"", 2);
+        else if (*s == '\n') tb_put(b, "\\n", 2);
+        else tb_put(b, s, 1);
+    }
+}
+
+// "nom{labels} valeur\n", labels déjà écrits (sans accolades) ; suffix : "_total" des compteurs
+static void tb_sample_u64(TextBuf *b, int fam, const char *suffix, const TextBuf *labels, unsigned long long v) {
+    char num[32];
+    tb_str(b, families[fam].name);
+    tb_str(b, suffix);
+    tb_put(b, "{", 1);
+    tb_put(b, labels->data, labels->len);
+    tb_put(b, "} ", 2);
+    tb_put(b, num, fmt_u64(num, v));
+    tb_put(b, "\n", 1);
+}
+
+static void tb_sample_fixed(TextBuf *b, int fam, const char *suffix, const TextBuf *labels, double v, int decimals) {
+    char num[48];
+    tb_str(b, families[fam].name);
+    tb_str(b, suffix);
+    tb_put(b, "{", 1);
+    tb_put(b, labels->data, labels->len);
+    tb_put(b, "} ", 2);
+    tb_put(b, num, fmt_fixed(num, v, decimals));
+    tb_put(b, "\n", 1);
+}
+
+// ----------- publication -----------------
+
+static void write_host(MetricsSource *src, const TextBuf *host, int count, const SystemStats *stats) {
+    static TextBuf labels;
+    static const char *periods[3] = { "1m", "5m", "15m" };
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    tb_sample_u64(&src->fam[M_HOST_PROCESSES], M_HOST_PROCESSES, "", host, count);
+    tb_sample_fixed(&src->fam[M_HOST_COLLECTED], M_HOST_COLLECTED, "", host, ts.tv_sec + ts.tv_nsec / 1e9, 3);
+    if (!stats) return; // hôte distant : pas d'en-tête système
+
+    tb_sample_fixed(&src->fam[M_HOST_CPU], M_HOST_CPU, "", host, stats->total_percent, 2);
+    tb_sample_u64(&src->fam[M_HOST_MEM_TOTAL], M_HOST_MEM_TOTAL, "", host, stats->mem_total);
+    tb_sample_u64(&src->fam[M_HOST_MEM_AVAILABLE], M_HOST_MEM_AVAILABLE, "", host, stats->mem_available);
+    for (int i = 0; i < 3; i++) {
+        labels.len = 0;
+        tb_put(&labels, host->data, host->len);
+        tb_str(&labels, ",period=\"");
+        tb_str(&labels, periods[i]);
+        tb_str(&labels, "\"");
+        tb_sample_fixed(&src->fam[M_HOST_LOAD], M_HOST_LOAD, "", &labels, stats->load[i], 2);
+    }
+    if (stats->psi_valid) {
+        static const struct { const char *resource, *kind; size_t off; } psi[] = {
+            { "cpu", "some", offsetof(SystemStats, psi_cpu_some) },
+            { "memory", "some", offsetof(SystemStats, psi_mem_some) },
+            { "memory", "full", offsetof(SystemStats, psi_mem_full) },
+            { "io", "some", offsetof(SystemStats, psi_io_some) },
+            { "io", "full", offsetof(SystemStats, psi_io_full) },
+        };
+        for (int i = 0; i < (int)(sizeof(psi) / sizeof(psi[0])); i++) {
+            labels.len = 0;
+            tb_put(&labels, host->data, host->len);
+            tb_str(&labels, ",resource=\"");
+            tb_str(&labels, psi[i].resource);
+            tb_str(&labels, "\",kind=\"");
+            tb_str(&labels, psi[i].kind);
+            tb_str(&labels, "\"");
+            double v = *(const double *)((const char *)stats + psi[i].off);
+            tb_sample_fixed(&src->fam[M_HOST_PRESSURE], M_HOST_PRESSURE, "", &labels, v, 2);
+        }
+    }
+}
+
+static void write_process(MetricsSource *src, const TextBuf *host, const ProcessInfo *p, double ticks) {
+    static TextBuf labels;
+    char num[32];
+    // labels communs à toutes les familles du processus, écrits une fois
+    labels.len = 0;
+    tb_put(&labels, host->data, host->len);
+    tb_str(&labels, ",pid=\"");
+    tb_put(&labels, num, fmt_u64(num, (unsigned long long)p->pid));
+    tb_str(&labels, "\",name=\"");
+    tb_label_value(&labels, process_name(p));
+    tb_str(&labels, "\",user=\"");
+    tb_label_value(&labels, process_user(p));
+    tb_str(&labels, "\"");
+
+    tb_sample_fixed(&src->fam[M_PROC_CPU], M_PROC_CPU, "", &labels, p->cpu_percent, 2);
+    tb_sample_fixed(&src->fam[M_PROC_CPU_SECONDS], M_PROC_CPU_SECONDS, "_total", &labels, p->time / ticks, 2);
+    tb_sample_u64(&src->fam[M_PROC_RES], M_PROC_RES, "", &labels, p->res);
+    tb_sample_u64(&src->fam[M_PROC_VIRT], M_PROC_VIRT, "", &labels, p->virt);
+    if (p->num_threads > 0) tb_sample_u64(&src->fam[M_PROC_THREADS], M_PROC_THREADS, "", &labels, p->num_threads);
+    if (p->sched_valid) tb_sample_fixed(&src->fam[M_PROC_DELAY], M_PROC_DELAY, "", &labels, p->sched_delay, 2);
+    if (p->alert) tb_sample_u64(&src->fam[M_PROC_ALERT], M_PROC_ALERT, "", &labels, p->alert);
+}
+
+// Corps complet : chaque famille une seule fois, ses échantillons de toutes les sources à la suite
+static void rebuild_body(void) {
+    body.len = 0;
+    for (int f = 0; f < M_NFAMILIES; f++) {
+        size_t total = 0;
+        for (int s = 0; s < METRICS_MAX_SOURCES; s++) {
+            if (sources[s].used) total += sources[s].fam[f].len;
+        }
+        if (total == 0) continue;
+        tb_str(&body, "# TYPE ");
+        tb_str(&body, families[f].name);
+        tb_str(&body, " ");
+        tb_str(&body, families[f].type);
+        tb_str(&body, "\n# HELP ");
+        tb_str(&body, families[f].name);
+        tb_str(&body, " ");
+        tb_str(&body, families[f].help);
+        tb_str(&body, "\n");
+        if (!tb_reserve(&body, total)) continue;
+        for (int s = 0; s < METRICS_MAX_SOURCES; s++) {
+            if (sources[s].used) tb_put(&body, sources[s].fam[f].data, sources[s].fam[f].len);
+        }
+    }
+    tb_str(&body, "# EOF\n");
+    head_len = snprintf(head, sizeof(head),
+                        "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                        "Content-Length: %zu\r\n"
+                        "Connection: close\r\n\r\n", body.len);
+}
+
+void metrics_publish(int source, const char *name, const ProcessInfo rows[], int count,
+                     const SystemStats *stats) {
+    if (listen_fd < 0 || source + 1 < 0 || source + 1 >= METRICS_MAX_SOURCES) return;
+    MetricsSource *src = &sources[source + 1];
+    for (int f = 0; f < M_NFAMILIES; f++) src->fam[f].len = 0;
+    src->used = 1;
+
+    static TextBuf host;
+    host.len = 0;
+    tb_str(&host, "host=\"");
+    tb_label_value(&host, name);
+    tb_str(&host, "\"");
+
+    // temps CPU : ticks d'horloge en local, secondes pour ps à distance
+    double ticks = (source < 0) ? (double)sysconf(_SC_CLK_TCK) : 1.0;
+    if (ticks <= 0) ticks = 100.0;
+    int procs = 0;
+    for (int i = 0; i < count; i++) {
+        if (rows[i].is_thread) continue;
+        write_process(src, &host, &rows[i], ticks);
+        procs++;
+    }
+    write_host(src, &host, procs, stats);
+    rebuild_body();
+}
+
+void metrics_drop_source(int source) {
+    if (listen_fd < 0 || source + 1 < 0 || source + 1 >= METRICS_MAX_SOURCES || !sources[source + 1].used) return;
+    sources[source + 1].used = 0;
+    rebuild_body();
+}
+
+// ----------- écoute HTTP -----------------
+
+int metrics_open(int port) {
+    if (port <= 0 || port > 65535) {
+        fprintf(stderr, "Port invalide pour --export-metrics: %d\n", port);
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // local uniquement : pas d'authentification
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        fprintf(stderr, "--export-metrics: 127.0.0.1:%d : %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    listen_fd = fd;
+    rebuild_body(); // corps vide ("# EOF") jusqu'à la première collecte
+    return 0;
+}
+
+int metrics_active(void) {
+    return listen_fd >= 0;
+}
+
+// Connexion en cours : requête lue par morceaux, puis réponse envoyée par morceaux.
+// out est NULL pendant la lecture ; ensuite il pointe sur le corps partagé, ou
+// sur une copie privée si l'envoi n'a pas tout passé d'un coup (le corps peut
+// être reconstruit par metrics_publish() avant la fin de l'envoi).
+typedef struct {
+    int fd;                   // -1 : emplacement libre
+    double since;             // horloge monotone à l'acceptation
+    size_t len;
+    char req[2048];
+    char *out;
+    size_t out_len;
+    size_t out_off;
+    int out_owned;            // 1 : out alloué pour cette connexion
+} MetricsConn;
+
+static MetricsConn conns[METRICS_MAX_CLIENTS];
+static int nconns = 0;
+
+static void conn_close(int i) {
+    close(conns[i].fd);
+    if (conns[i].out_owned) free(conns[i].out);
+    conns[i] = conns[--nconns];
+}
+
+// Envoie ce que la socket accepte sans bloquer. Retourne le nombre d'octets envoyés, ou -1
+static ssize_t send_some(int fd, struct iovec *iov, int iovcnt) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT); // client parti : pas de SIGPIPE
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    return n;
+}
+
+// Requête complète : première tentative d'envoi directement depuis l'en-tête et
+// le corps partagés, le reste (socket pleine) est copié pour les appels suivants.
+// Retourne 1 si la réponse est entièrement partie, 0 si elle reste en attente, -1 sinon
+static int conn_respond(MetricsConn *c) {
+    static const char not_found[] =
+        "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 20\r\n"
+        "Connection: close\r\n\r\nGET /metrics only.\r\n";
+    struct iovec iov[2];
+    int iovcnt;
+    int is_get = (strncmp(c->req, "GET ", 4) == 0);
+    const char *path = c->req + 4;
+    size_t path_len = is_get ? strcspn(path, " ?\r\n") : 0;
+    if (is_get && path_len == 8 && strncmp(path, "/metrics", 8) == 0) {
+        iov[0] = (struct iovec){ head, head_len };
+        iov[1] = (struct iovec){ body.data, body.len };
+        iovcnt = 2;
+    } else {
+        iov[0] = (struct iovec){ (void *)not_found, sizeof(not_found) - 1 };
+        iovcnt = 1;
+    }
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) total += iov[i].iov_len;
+    ssize_t n = send_some(c->fd, iov, iovcnt);
+    if (n < 0) return -1;
+    if ((size_t)n == total) return 1;
+
+    c->out_len = total - n;
+    c->out = malloc(c->out_len);
+    if (!c->out) return -1;
+    c->out_owned = 1;
+    c->out_off = 0;
+    size_t off = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        size_t skip = (size_t)n < iov[i].iov_len ? (size_t)n : iov[i].iov_len;
+        memcpy(c->out + off, (char *)iov[i].iov_base + skip, iov[i].iov_len - skip);
+        off += iov[i].iov_len - skip;
+        n -= skip;
+    }
+    return 0;
+}
+
+// Fait avancer une connexion sans bloquer : 1 terminée (à fermer), 0 en attente
+static int conn_progress(MetricsConn *c) {
+    if (c->out) {
+        struct iovec iov = { c->out + c->out_off, c->out_len - c->out_off };
+        ssize_t n = send_some(c->fd, &iov, 1);
+        if (n < 0) return 1;
+        c->out_off += n;
+        return c->out_off == c->out_len;
+    }
+    for (;;) {
+        if (c->len >= sizeof(c->req) - 1) break; // requête trop longue : traitée telle quelle
+        ssize_t n = read(c->fd, c->req + c->len, sizeof(c->req) - 1 - c->len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return 1;
+        c->len += n;
+        c->req[c->len] = '\0';
+        if (strstr(c->req, "\r\n\r\n") || strstr(c->req, "\n\n")) break;
+    }
+    c->req[c->len] = '\0';
+    return conn_respond(c) != 0;
+}
+
+int metrics_poll_fds(struct pollfd *fds) {
+    if (listen_fd < 0) return 0;
+    int n = 0;
+    if (nconns < METRICS_MAX_CLIENTS) { // sinon les connexions attendent dans la file d'écoute
+        fds[n].fd = listen_fd;
+        fds[n].events = POLLIN;
+        fds[n++].revents = 0;
+    }
+    for (int i = 0; i < nconns; i++) {
+        fds[n].fd = conns[i].fd;
+        fds[n].events = conns[i].out ? POLLOUT : POLLIN;
+        fds[n++].revents = 0;
+    }
+    return n;
+}
+
+void metrics_serve(void) {
+    if (listen_fd < 0) return;
+    double now = refresh_now();
+    while (nconns < METRICS_MAX_CLIENTS) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) break; // EAGAIN : plus de connexion en attente
+        MetricsConn *c = &conns[nconns++];
+        c->fd = fd;
+        c->since = now;
+        c->len = 0;
+        c->req[0] = '\0';
+        c->out = NULL;
+        c->out_len = c->out_off = 0;
+        c->out_owned = 0;
+    }
+    for (int i = 0; i < nconns; i++) {
+        if (conn_progress(&conns[i]) || now - conns[i].since > METRICS_CLIENT_TIMEOUT) conn_close(i--);
+    }
+}
+
+void metrics_close(void) {
+    while (nconns > 0) conn_close(nconns - 1);
+    if (listen_fd >= 0) close(listen_fd);
+    listen_fd = -1;
+    for (int s = 0; s < METRICS_MAX_SOURCES; s++) {
+        for (int f = 0; f < M_NFAMILIES; f++) {
+            free(sources[s].fam[f].data);
+            memset(&sources[s].fam[f], 0, sizeof(TextBuf));
+        }
+        sources[s].used = 0;
+    }
+    free(body.data);
+    memset(&body, 0, sizeof(body));
+}
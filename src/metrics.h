@@ -0,0 +1,45 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <poll.h>
+#include "manager.h"
+#include "process.h"
+#include "sysstats.h"
+
+// Export OpenMetrics (--export-metrics PORT) : GET /metrics sur 127.0.0.1:PORT
+// renvoie le dernier instantané de chaque source publiée (machine locale et
+// hôtes distants, label host).
+//
+// Le texte est produit une fois par collecte dans metrics_publish() : chaque
+// source garde un segment par famille de métriques, et le corps complet est
+// réassemblé (copie des segments, familles regroupées comme l'exige le format)
+// dans un tampon réutilisé. Une requête n'est qu'un envoi de ce tampon.
+
+#define METRICS_MAX_SOURCES (MAX_HOSTS + 1)
+#define METRICS_MAX_CLIENTS 16         // connexions ouvertes en même temps
+#define METRICS_CLIENT_TIMEOUT 5.0     // secondes : un client plus lent est coupé
+
+// Ouvre l'écoute sur 127.0.0.1:port. Retourne 0, ou -1 (message sur stderr).
+int metrics_open(int port);
+int metrics_active(void);
+// Remplit fds (METRICS_MAX_CLIENTS + 1 places) avec l'écoute et les connexions
+// en cours, chacune avec l'événement attendu. Retourne le nombre d'entrées.
+int metrics_poll_fds(struct pollfd *fds);
+
+// Remplace l'instantané d'une source (-1 : locale, sinon index d'hôte) et
+// reconstruit le corps servi. stats : NULL pour un hôte distant.
+// Les lignes de thread sont ignorées.
+void metrics_publish(int source, const char *name, const ProcessInfo rows[], int count,
+                     const SystemStats *stats);
+
+// Retire une source du corps servi (hôte retiré de la configuration)
+void metrics_drop_source(int source);
+
+// Accepte les connexions en attente et fait avancer chacune (lecture de la
+// requête, puis envoi de la réponse) sans jamais bloquer : un client lent ne
+// retarde pas la collecte, il est coupé après METRICS_CLIENT_TIMEOUT
+void metrics_serve(void);
+
+void metrics_close(void);
+
+#endif
@@ -1,11 +1,16 @@
 
 // Implémentations futures...
+#define _GNU_SOURCE // memmem
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <libssh/libssh.h>
 #include "network.h"
 #include "process.h"
+#include "filter.h"
+#include "profile.h"
+
+#define PS_COMM_WIDTH 15 // "comm:15" in the ps command below (TASK_COMM_LEN - 1)
 
 // 1. Establish the SSH Connection
 int network_connect(RemoteHost *host, ssh_session *session_out) {
@@ -37,6 +42,147 @@ int network_connect(RemoteHost *host, ssh_session *session_out) {
     return 0; // Success
 }
 
+// ----------- ps output parser -----------------
+// Hand-rolled scanner over [p, end): no NUL terminator needed, no copies
+
+static const char *skip_blanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Unsigned integer; ps prints "-" for values it cannot show (e.g. NI of RT tasks)
+static const char *scan_ulong(const char *p, const char *end, unsigned long *out) {
+    p = skip_blanks(p, end);
+    unsigned long v = 0;
+    const char *start = p;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    if (p == start) {
+        if (p < end && *p == '-') { *out = 0; return p + 1; }
+        return NULL;
+    }
+    *out = v;
+    return p;
+}
+
+static const char *scan_long(const char *p, const char *end, long *out) {
+    p = skip_blanks(p, end);
+    int neg = (p + 1 < end && *p == '-' && p[1] >= '0' && p[1] <= '9');
+    unsigned long v;
+    p = scan_ulong(p + neg, end, &v);
+    if (p) *out = neg ? -(long)v : (long)v;
+    return p;
+}
+
+// "12.3" -> 12.3 (ps prints pmem/pcpu with one decimal)
+static const char *scan_decimal(const char *p, const char *end, double *out) {
+    unsigned long ip;
+    p = scan_ulong(p, end, &ip);
+    if (!p) return NULL;
+    double v = (double)ip, scale = 0.1;
+    if (p < end && (*p == '.' || *p == ',')) {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, scale *= 0.1) v += (*p - '0') * scale;
+    }
+    *out = v;
+    return p;
+}
+
+// Copies one whitespace-delimited token, truncated to size - 1
+static const char *scan_token(const char *p, const char *end, char *dst, size_t size) {
+    p = skip_blanks(p, end);
+    size_t n = 0;
+    while (p < end && *p != ' ' && *p != '\t') {
+        if (n + 1 < size) dst[n++] = *p;
+        p++;
+    }
+    dst[n] = '\0';
+    return n ? p : NULL;
+}
+
+// ps format: PID USER S PRI NI VSZ RSS %MEM %CPU TIME PSR COMMAND(comm, 15 columns) COMMAND(args)
+static int parse_ps_line(const char *p, const char *end, ProcessInfo *info) {
+    unsigned long pid, vsz_kb, rss_kb, time, psr;
+    char state[2], user[64];
+    memset(info, 0, sizeof(*info));
+    if (!(p = scan_ulong(p, end, &pid))) return 0;
+    if (!(p = scan_token(p, end, user, sizeof(user)))) return 0;
+    if (!(p = scan_token(p, end, state, sizeof(state)))) return 0;
+    if (!(p = scan_long(p, end, &info->priority))) return 0;
+    if (!(p = scan_long(p, end, &info->nice))) return 0;
+    if (!(p = scan_ulong(p, end, &vsz_kb))) return 0;
+    if (!(p = scan_ulong(p, end, &rss_kb))) return 0;
+    if (!(p = scan_decimal(p, end, &info->mem_percent))) return 0;
+    if (!(p = scan_decimal(p, end, &info->cpu_percent))) return 0;
+    if (!(p = scan_ulong(p, end, &time))) return 0;
+    if (!(p = scan_ulong(p, end, &psr))) return 0;
+
+    // comm is padded to PS_COMM_WIDTH (it may contain spaces), args is the
+    // rest of the line
+    while (end > p && (end[-1] == ' ' || end[-1] == '\r')) end--;
+    if (p < end && *p == ' ') p++;
+    const char *comm = p;
+    const char *comm_end = (end - p > PS_COMM_WIDTH) ? p + PS_COMM_WIDTH : end;
+    p = comm_end;
+    while (comm_end > comm && comm_end[-1] == ' ') comm_end--;
+    p = skip_blanks(p, end);
+
+    // interned: repeated names and command lines cost a lookup, not a copy
+    info->user_id = strpool_intern(user, strlen(user));
+    info->name_id = strpool_intern(comm, comm_end - comm);
+    info->cmd_id = strpool_intern(p, end - p);
+
+    info->pid = (int)pid;
+    info->tgid = info->pid;
+    info->state = state[0];
+    info->virt = vsz_kb * 1024;
+    info->res  = rss_kb * 1024;
+    info->shr  = 0; // ps doesn't give shared mem easily
+    info->time = time;
+    info->last_cpu = (int)psr;
+    info->numa_node = -1; // the remote topology is unknown
+    return 1;
+}
+
+typedef struct {
+    ProcessInfo *rows;
+    int max_count;
+    const Filter *filter;
+    int count;
+    int lines;
+    size_t carry_len;
+    char carry[256 + CMDLINE_MAX];  // partial line left over from the previous read
+} PsParser;
+
+static void ps_parser_line(PsParser *ps, const char *p, const char *end) {
+    int first = (ps->lines++ == 0);
+    if (ps->count >= ps->max_count || p == end) return; // keep draining the channel
+    if (first && memmem(p, end - p, "PID", 3)) return;  // header
+    ProcessInfo *info = &ps->rows[ps->count];
+    // the remote awk already filtered; re-check in case awk was unavailable
+    if (parse_ps_line(p, end, info) && filter_match_all(ps->filter, info)) ps->count++;
+}
+
+static void ps_parser_feed(PsParser *ps, const char *buf, size_t len) {
+    const char *p = buf, *end = buf + len;
+    const char *nl;
+    while ((nl = memchr(p, '\n', end - p)) != NULL) {
+        if (ps->carry_len > 0) {
+            // finish the split line in the carry buffer (overlong lines are truncated)
+            size_t n = nl - p;
+            if (n > sizeof(ps->carry) - ps->carry_len) n = sizeof(ps->carry) - ps->carry_len;
+            memcpy(ps->carry + ps->carry_len, p, n);
+            ps_parser_line(ps, ps->carry, ps->carry + ps->carry_len + n);
+            ps->carry_len = 0;
+        } else {
+            ps_parser_line(ps, p, nl);
+        }
+        p = nl + 1;
+    }
+    size_t rest = end - p;
+    if (rest > sizeof(ps->carry) - ps->carry_len) rest = sizeof(ps->carry) - ps->carry_len;
+    memcpy(ps->carry + ps->carry_len, p, rest);
+    ps->carry_len += rest;
+}
+
 // 2. Run 'ps' and Parse Output
 int network_collect(ssh_session session, ProcessInfo processes[], int max_count) {
     ssh_channel channel;
@@ -45,74 +191,59 @@ int network_collect(ssh_session session, ProcessInfo processes[], int max_count)
     int nbytes;
     int count = 0;
 
+    prof_start(PROF_NET_EXEC);
     channel = ssh_channel_new(session);
-    if (channel == NULL) return 0;
+    if (channel == NULL) {
+        prof_stop(PROF_NET_EXEC);
+        return 0;
+    }
 
     if (ssh_channel_open_session(channel) != SSH_OK) {
         ssh_channel_free(channel);
+        prof_stop(PROF_NET_EXEC);
         return 0;
     }
 
     // The command: match the columns to your struct
     // pid, user, state, priority, nice, virt(kb), res(kb), mem%, cpu%, time(sec), command
     //const char *cmd = "ps -Ao pid,user,state,pri,ni,vsz,rss,pmem,pcpu,times,comm --no-headers --sort=-pcpu | head -n 50";
-    const char *cmd = "ps -A -o pid,user,state,pri,ni,vsz,rss,pmem,pcpu,times,comm"; //suppression des flags complexes pour une meilleure compatibilité 
+    // comm at a fixed width so that args (full command line) can follow it; -ww: never cut args
+    const char *ps_cmd = "ps -A -ww -o pid,user,state,pri,ni,vsz,rss,pmem,pcpu,times,psr,comm:15,args"; //suppression des flags complexes pour une meilleure compatibilité 
+
+    // Push the active filter down to the remote side as an awk condition,
+    // so filtered-out rows never cross the wire
+    const Filter *filter = filter_get_active();
+    char cmd[MAX_FILTER_LEN * 4 + 128];
+    char awk_cond[MAX_FILTER_LEN * 4];
+    if (filter->count > 0 && filter_to_awk(filter, awk_cond, sizeof(awk_cond)) == 0) {
+        snprintf(cmd, sizeof(cmd), "%s | awk '%s'", ps_cmd, awk_cond);
+    } else {
+        snprintf(cmd, sizeof(cmd), "%s", ps_cmd);
+    }
     rc = ssh_channel_request_exec(channel, cmd);
+    prof_stop(PROF_NET_EXEC);
     if (rc != SSH_OK) {
         ssh_channel_close(channel);
         ssh_channel_free(channel);
         return 0;
     }
 
-    // Buffer to accumulate output
-    char output_acc[16384] = ""; 
-    
-    // Simple read loop (in production, handle large outputs more robustly)
+    // Stream the output: complete lines are parsed in place in the read
+    // buffer, only a line split across two reads is carried over
+    PsParser parser = { .rows = processes, .max_count = max_count, .filter = filter };
+    prof_start(PROF_NET_READ);
     while ((nbytes = ssh_channel_read(channel, buffer, sizeof(buffer), 0)) > 0) {
-        if (strlen(output_acc) + nbytes < sizeof(output_acc) - 1) {
-            strncat(output_acc, buffer, nbytes);
-        }
-    }
-
-    // Parse the accumulated string line by line
-    char *line = strtok(output_acc, "\n");
-    int cur_line=0;
-    while (line != NULL && count < max_count) {
-        if (cur_line==0 && strstr(line, "PID")){
-            line = strtok(NULL, "\n");
-            cur_line++;
-            continue;
-        }
-
-        ProcessInfo *p = &processes[count];
-        
-        
-        unsigned long vsz_kb = 0, rss_kb = 0;
-        
-        // ps format: PID USER S PRI NI VSZ RSS %MEM %CPU TIME COMMAND
-        int fields = sscanf(line, "%d %63s %c %ld %ld %lu %lu %lf %lf %lu %255s",
-            &p->pid,
-            p->user,
-            &p->state,
-            &p->priority,
-            &p->nice,
-            &vsz_kb,
-            &rss_kb,
-            &p->mem_percent,
-            &p->cpu_percent,
-            &p->time,
-            p->name
-        );
-
-        if (fields >= 10) { // If we parsed enough fields
-            p->virt = vsz_kb * 1024;
-            p->res  = rss_kb * 1024;
-            p->shr  = 0; // ps doesn't give shared mem easily
-            count++;
-        }
-
-        line = strtok(NULL, "\n");
+        PROF_READ(nbytes);
+        prof_stop(PROF_NET_READ);
+        prof_start(PROF_NET_PARSE);
+        ps_parser_feed(&parser, buffer, nbytes);
+        prof_stop(PROF_NET_PARSE);
+        prof_start(PROF_NET_READ);
     }
+    prof_stop(PROF_NET_READ);
+    if (parser.carry_len > 0) ps_parser_line(&parser, parser.carry, parser.carry + parser.carry_len);
+    count = parser.count;
+    strpool_collect();
 
     ssh_channel_send_eof(channel);
     ssh_channel_close(channel);
@@ -161,8 +292,19 @@ int remote_command_handling(ssh_session session, char *command) {
         printf("  pause <pid>   : Suspend process (SIGSTOP/19)\n");
         printf("  resume <pid>  : Unfreeze process (SIGCONT/18)\n");
         printf("  restart <pid> : Reload process (SIGHUP/1)\n");
+        printf("  filter <expr> : Only show matching rows, e.g. 'user=postgres cpu>5 name~java' (empty: clear)\n");
         goto out;
     } 
+    else if (strcmp(action, "filter") == 0) {
+        char *expr = strtok(NULL, "\n");
+        char err[128];
+        if (filter_set_active(expr ? expr : "", err, sizeof(err)) != 0) {
+            printf("Invalid filter: %s\n", err);
+        } else {
+            printf("Filter %s (applied on the remote side)\n", expr ? "set" : "cleared");
+        }
+        goto out;
+    }
     else if (strcmp(action, "quit") == 0 || strcmp(action, "q") == 0) {
         exit(0);
     }
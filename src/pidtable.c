@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/resource.h>
+#include "pidtable.h"
+#include "profile.h"
+
+#define PIDTABLE_MIN_CAPACITY 1024
+#define FD_RESERVE 128 // descripteurs laissés libres pour le reste du programme
+
+// Budget global de descripteurs mis en cache (toutes tables confondues)
+static int fd_cached = 0;
+static int fd_limit = -1;
+
+static unsigned int hash_pid(int pid) {
+    unsigned int h = (unsigned int)pid * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+static void init_fd_limit(void) {
+    struct rlimit rl;
+    fd_limit = 0;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0) return;
+    // On monte la limite souple jusqu'à la limite dure pour pouvoir garder
+    // les fichiers stat ouverts sur les machines très chargées
+    if (rl.rlim_cur < rl.rlim_max) {
+        rlim_t wanted = (rl.rlim_max == RLIM_INFINITY || rl.rlim_max > 1048576) ? 1048576 : rl.rlim_max;
+        if (wanted > rl.rlim_cur) {
+            rl.rlim_cur = wanted;
+            setrlimit(RLIMIT_NOFILE, &rl);
+            getrlimit(RLIMIT_NOFILE, &rl);
+        }
+    }
+    if (rl.rlim_cur > FD_RESERVE) fd_limit = (int)(rl.rlim_cur - FD_RESERVE);
+}
+
+static void slot_reset(PidState *s) {
+    memset(s, 0, sizeof(*s));
+    s->stat_fd = -1;
+    s->statm_fd = -1;
+    s->io_fd = -1;
+    s->sched_fd = -1;
+    s->cmd_name = -1;
+}
+
+static int pidtable_grow(PidTable *t) {
+    int new_cap = t->capacity ? t->capacity * 2 : PIDTABLE_MIN_CAPACITY;
+    PidState *slots = malloc(sizeof(PidState) * new_cap);
+    if (!slots) return 0;
+    for (int i = 0; i < new_cap; i++) slot_reset(&slots[i]);
+
+    for (int i = 0; i < t->capacity; i++) {
+        if (t->slots[i].pid == 0) continue;
+        unsigned int j = hash_pid(t->slots[i].pid) & (new_cap - 1);
+        while (slots[j].pid != 0) j = (j + 1) & (new_cap - 1);
+        slots[j] = t->slots[i];
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->capacity = new_cap;
+    return 1;
+}
+
+PidState *pidtable_find(PidTable *t, int pid) {
+    if (t->capacity == 0 || pid <= 0) return NULL;
+    unsigned int mask = t->capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+    while (t->slots[i].pid != 0) {
+        if (t->slots[i].pid == pid) return &t->slots[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+PidState *pidtable_get(PidTable *t, int pid) {
+    if (pid <= 0) return NULL;
+    PidState *s = pidtable_find(t, pid);
+    if (!s) {
+        // charge maximale 1/2 pour garder des sondages courts
+        if ((t->used + 1) * 2 > t->capacity && !pidtable_grow(t)) return NULL;
+        unsigned int mask = t->capacity - 1;
+        unsigned int i = hash_pid(pid) & mask;
+        while (t->slots[i].pid != 0) i = (i + 1) & mask;
+        s = &t->slots[i];
+        slot_reset(s);
+        s->pid = pid;
+        t->used++;
+    }
+    s->epoch = t->epoch;
+    return s;
+}
+
+// Retire l'entrée de la liste d'enfants de son parent
+static void pidtable_unlink(PidTable *t, PidState *st) {
+    if (!st->linked) return;
+    if (st->prev_sibling) {
+        PidState *prev = pidtable_find(t, st->prev_sibling);
+        if (prev) prev->next_sibling = st->next_sibling;
+    } else {
+        PidState *parent = pidtable_find(t, st->ppid);
+        if (parent && parent->first_child == st->pid) parent->first_child = st->next_sibling;
+    }
+    if (st->next_sibling) {
+        PidState *next = pidtable_find(t, st->next_sibling);
+        if (next) next->prev_sibling = st->prev_sibling;
+    }
+    st->prev_sibling = st->next_sibling = 0;
+    st->linked = 0;
+}
+
+void pidtable_set_parent(PidTable *t, PidState *st, int ppid) {
+    if (st->linked && st->ppid == ppid) return; // cas courant : rien ne change
+    pidtable_unlink(t, st);
+    st->ppid = ppid;
+
+    PidState *parent = pidtable_find(t, ppid);
+    if (!parent || parent == st) return; // racine (ou parent pas encore connu)
+
+    // insertion en tête de la liste d'enfants
+    st->next_sibling = parent->first_child;
+    if (parent->first_child) {
+        PidState *head = pidtable_find(t, parent->first_child);
+        if (head) head->prev_sibling = st->pid;
+    }
+    parent->first_child = st->pid;
+    st->linked = 1;
+}
+
+// Détache une entrée disparue : retrait chez son parent, et ses enfants
+// deviennent orphelins (ils seront rattachés à leur nouveau parent au
+// prochain passage, quand /proc indiquera le ppid du processus adoptant)
+static void pidtable_detach(PidTable *t, PidState *st) {
+    pidtable_unlink(t, st);
+    int child = st->first_child;
+    while (child) {
+        PidState *c = pidtable_find(t, child);
+        if (!c) break;
+        child = c->next_sibling;
+        c->prev_sibling = c->next_sibling = 0;
+        c->linked = 0;
+    }
+    st->first_child = 0;
+}
+
+void pidtable_renew(PidTable *t, PidState *st) {
+    pidtable_detach(t, st);
+    pidtable_close_fd(&st->statm_fd);
+    pidtable_close_fd(&st->io_fd);
+    pidtable_close_fd(&st->sched_fd);
+    int pid = st->pid, stat_fd = st->stat_fd;
+    unsigned int epoch = st->epoch;
+    slot_reset(st);
+    st->pid = pid;
+    st->stat_fd = stat_fd;
+    st->epoch = epoch;
+}
+
+// Suppression par décalage arrière (pas de pierres tombales)
+static void pidtable_remove_at(PidTable *t, unsigned int i) {
+    unsigned int mask = t->capacity - 1;
+    pidtable_close_fd(&t->slots[i].stat_fd);
+    pidtable_close_fd(&t->slots[i].statm_fd);
+    pidtable_close_fd(&t->slots[i].io_fd);
+    pidtable_close_fd(&t->slots[i].sched_fd);
+    slot_reset(&t->slots[i]);
+    t->used--;
+
+    unsigned int j = i;
+    while (1) {
+        j = (j + 1) & mask;
+        if (t->slots[j].pid == 0) break;
+        unsigned int home = hash_pid(t->slots[j].pid) & mask;
+        // l'élément j peut-il remonter en i ? (home hors de l'intervalle ]i, j])
+        int movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            t->slots[i] = t->slots[j];
+            slot_reset(&t->slots[j]);
+            i = j;
+        }
+    }
+}
+
+void pidtable_begin(PidTable *t) {
+    t->epoch++;
+}
+
+void pidtable_sweep(PidTable *t) {
+    // 1er passage : mise à jour de l'index parent -> enfants
+    for (int i = 0; i < t->capacity; i++) {
+        if (t->slots[i].pid != 0 && t->slots[i].epoch != t->epoch) {
+            pidtable_detach(t, &t->slots[i]);
+        }
+    }
+    // 2e passage : suppression
+    for (int i = 0; i < t->capacity; ) {
+        if (t->slots[i].pid != 0 && t->slots[i].epoch != t->epoch) {
+            pidtable_remove_at(t, i); // un autre élément a pu glisser en i : on le réexamine
+        } else {
+            i++;
+        }
+    }
+}
+
+void pidtable_free(PidTable *t) {
+    for (int i = 0; i < t->capacity; i++) {
+        pidtable_close_fd(&t->slots[i].stat_fd);
+        pidtable_close_fd(&t->slots[i].statm_fd);
+        pidtable_close_fd(&t->slots[i].io_fd);
+        pidtable_close_fd(&t->slots[i].sched_fd);
+    }
+    free(t->slots);
+    memset(t, 0, sizeof(*t));
+}
+
+void pidtable_close_fd(int *fd) {
+    if (*fd >= 0) {
+        close(*fd);
+        PROF_SYSCALL();
+        *fd = -1;
+        fd_cached--;
+    }
+}
+
+int pidtable_read(int *fd, const char *path, char *buf, int size) {
+    if (fd_limit < 0) init_fd_limit();
+
+    if (*fd >= 0) {
+        ssize_t n = pread(*fd, buf, size - 1, 0);
+        PROF_READ(n > 0 ? n : 0);
+        if (n > 0) {
+            buf[n] = '\0';
+            return (int)n;
+        }
+        // processus terminé ou pid réutilisé : on rouvre une fois
+        pidtable_close_fd(fd);
+    }
+
+    int new_fd = open(path, O_RDONLY | O_CLOEXEC);
+    PROF_OPEN();
+    if (new_fd < 0) return -1;
+    ssize_t n = read(new_fd, buf, size - 1);
+    PROF_READ(n > 0 ? n : 0);
+    if (n <= 0) {
+        int saved = errno;
+        close(new_fd);
+        PROF_SYSCALL();
+        errno = saved;
+        return -1;
+    }
+    buf[n] = '\0';
+
+    if (fd_cached < fd_limit) {
+        *fd = new_fd;
+        fd_cached++;
+    } else {
+        close(new_fd); // budget atteint : lecture sans cache
+        PROF_SYSCALL();
+    }
+    return (int)n;
+}
+
+int pidtable_read_once(const char *path, char *buf, int size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    PROF_OPEN();
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    PROF_READ(n > 0 ? n : 0);
+    int saved = errno;
+    close(fd);
+    PROF_SYSCALL();
+    errno = saved;
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
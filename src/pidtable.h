@@ -0,0 +1,89 @@
+#ifndef PIDTABLE_H
+#define PIDTABLE_H
+
+// État conservé entre deux rafraîchissements pour un PID (ou un TID)
+typedef struct {
+    int pid;                  // 0 : entrée libre
+    unsigned int epoch;       // dernier balayage où le pid a été vu
+    unsigned long prev_time;  // utime+stime de la mesure précédente
+    int stat_fd;              // descripteur /proc/<pid>/stat en cache, -1 sinon
+    int samples;              // nombre de mesures (0 : pid tout juste apparu)
+    unsigned long long starttime; // 22e champ de stat : distingue deux processus de même pid
+    int start_known;          // 0 : stat pas encore lu
+    int statm_fd;             // /proc/<pid>/statm en cache (lectures io_uring seulement), -1 sinon
+
+    // /proc/<pid>/io, lu seulement si les colonnes I/O sont utiles
+    int io_fd;                // descripteur en cache, -1 sinon
+    int io_denied;            // 1 : accès refusé, on ne réessaie plus pour ce pid
+    unsigned long long prev_read_bytes;
+    unsigned long long prev_write_bytes;
+    double prev_io_time;      // horodatage monotone de la mesure précédente (0 : aucune)
+
+    // /proc/<pid>/schedstat (délai en file d'exécution), lu avec stat si demandé
+    int sched_fd;             // descripteur en cache, -1 sinon
+    unsigned long long prev_wait_ns;  // temps passé en attente de CPU, cumul précédent
+    double prev_sched_time;   // horodatage monotone de la mesure précédente (0 : aucune)
+
+    int cgroup_id;            // chemin dans le pool de chaînes (0 : pas encore lu, -1 : illisible, relu)
+
+    // Chaînes internées (strpool) : comm comparé à chaque lecture de stat, la
+    // ligne de commande lue une fois par vie de pid, relue si comm change (exec)
+    int name_id;
+    int cmd_id;
+    int cmd_name;             // name_id lors de la lecture de cmdline (-1 : pas encore lue)
+
+    // /proc/<pid>/smaps_rollup, coûteux : lu pour les lignes affichées puis
+    // rafraîchi en tâche de fond toutes les SMAPS_INTERVAL secondes
+    int smaps_state;          // 0 : jamais lu, 1 : valeurs valides, -1 : illisible (droits, noyau < 4.14)
+    double smaps_time;        // horodatage monotone de la dernière lecture
+    unsigned long pss;        // octets
+    unsigned long uss;        // Private_Clean + Private_Dirty, octets
+    unsigned long swap;       // octets
+
+    // Index parent -> enfants, tenu à jour au fil des apparitions/disparitions
+    // (les liens sont des pids : les entrées peuvent bouger dans la table)
+    int ppid;
+    int linked;               // 1 si chaîné dans la liste d'enfants de ppid
+    int first_child;
+    int next_sibling;
+    int prev_sibling;
+    int row;                  // position dans le tableau trié (vue arborescente)
+    unsigned int row_epoch;   // balayage pour lequel row est valide
+} PidState;
+
+// Table de hachage (adressage ouvert, sondage linéaire) indexée par pid
+typedef struct {
+    PidState *slots;
+    int capacity;             // puissance de 2
+    int used;
+    unsigned int epoch;       // incrémenté à chaque balayage
+} PidTable;
+
+// Retourne l'entrée du pid, en la créant si besoin (NULL si plus de mémoire)
+PidState *pidtable_get(PidTable *t, int pid);
+// Retourne l'entrée du pid ou NULL
+PidState *pidtable_find(PidTable *t, int pid);
+// Démarre un balayage : les entrées non revues avant pidtable_sweep() sont supprimées
+void pidtable_begin(PidTable *t);
+// Supprime les entrées non vues depuis pidtable_begin() et ferme leurs descripteurs
+void pidtable_sweep(PidTable *t);
+void pidtable_free(PidTable *t);
+
+// Le pid a été réattribué à un autre processus : l'état du précédent est
+// oublié (comme une entrée neuve), sauf le descripteur de stat déjà rouvert
+void pidtable_renew(PidTable *t, PidState *st);
+
+// Rattache l'entrée à son parent dans l'index parent -> enfants.
+// Ne fait rien si le parent n'a pas changé depuis le dernier appel.
+void pidtable_set_parent(PidTable *t, PidState *st, int ppid);
+
+// Lit un fichier de /proc en réutilisant *fd (pread à l'offset 0).
+// Ouvre le fichier si *fd < 0 et le garde ouvert tant que le budget de
+// descripteurs le permet. Retourne la taille lue (buf terminé par '\0') ou -1.
+int pidtable_read(int *fd, const char *path, char *buf, int size);
+// Lecture ponctuelle sans cache (open/read/close). Retourne la taille lue ou -1.
+int pidtable_read_once(const char *path, char *buf, int size);
+// Ferme un descripteur en cache et le rend au budget
+void pidtable_close_fd(int *fd);
+
+#endif
@@ -5,8 +5,28 @@
 #include <string.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <errno.h>
+#include <time.h>
 #include "process.h" 
+#include "sysstats.h"
+#include "pidtable.h"
+#include "cgroup.h"
+#include "filter.h"
+#include "profile.h"
+#include "uring.h"
 
+// Racine du procfs lu par la collecte ("/proc" sauf pour les benchmarks ou un instantané)
+static char proc_root[PROC_ROOT_MAX] = "/proc";
+
+void process_set_proc_root(const char *root) {
+    snprintf(proc_root, sizeof(proc_root), "%s", root);
+    size_t len = strlen(proc_root);
+    while (len > 1 && proc_root[len - 1] == '/') proc_root[--len] = '\0';
+}
+
+const char *process_proc_root(void) {
+    return proc_root;
+}
 
 // Vérifie si une entrée est un PID
 int is_pid(const char *name) {
@@ -16,81 +36,133 @@ int is_pid(const char *name) {
     return 1;
 }
 
-// Lit /proc/<pid>/stat
-// Extrait le PID, nom, état, temps CPU, priorité, nice
-int read_stat(const char *pid_str, ProcessInfo *info) {
-    char path[256];
-    FILE *f;
-    snprintf(path, sizeof(path), "/proc/%s/stat", pid_str); // Construit le chemin du fichier du processus
-    f = fopen(path, "r"); // Ouvre le fichier en lecture
-    if (!f) return 0;
-
-    int pid;
-    char comm[256], state;
-    unsigned long utime, stime;
-    long priority, nice;
-
-    // Lecture des 3 premiers champs (PID, COMM, STATE)
-    fscanf(f, "%d %s %c", &pid, comm, &state);
-
-    // Ignorer les champs
-    for (int i = 4; i <= 13; i++) fscanf(f, "%*s"); // * ignore
-    
-    // utime (14e champ) : temps CPU utilisateur
-    // stime (15e champ) : temps CPU noyau
-    fscanf(f, "%lu %lu", &utime, &stime);
-    
-    // Ignorer
-    for (int i = 16; i <= 17; i++) fscanf(f, "%*s");
-    
-    // priority (18e champ)
-    // nice (19e champ)
-    fscanf(f, "%ld %ld", &priority, &nice);
+// Lecture rapide d'un entier signé, avance le curseur
+static long parse_long(const char **p) {
+    const char *s = *p;
+    long v = 0;
+    int neg = 0;
+    while (*s == ' ') s++;
+    if (*s == '-') { neg = 1; s++; }
+    while (*s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+    *p = s;
+    return neg ? -v : v;
+}
 
-    fclose(f);
+// Saute n champs séparés par des espaces
+static const char *skip_fields(const char *s, int n) {
+    while (n-- > 0) {
+        while (*s == ' ') s++;
+        while (*s && *s != ' ') s++;
+    }
+    return s;
+}
 
-    info->pid = pid;
+// Parseur de /proc/<pid>/stat à partir d'un tampon déjà lu
+// Le nom (2e champ) peut contenir des espaces et des parenthèses : on se cale
+// sur la dernière ')' de la ligne. Le nom est rendu dans *comm, sans être interné,
+// et la date de démarrage dans *starttime (identifie le processus derrière le pid).
+static int parse_stat_fields(const char *buf, ProcessInfo *info, const char **comm, size_t *comm_len,
+                             unsigned long long *starttime) {
+    const char *open_par = strchr(buf, '(');
+    const char *close_par = strrchr(buf, ')');
+    if (!open_par || !close_par || close_par < open_par) return 0;
 
-    // Nettoyer la commande (souvent entourée de parenthèses)
-    size_t len = strlen(comm);
-    if (len > 0 && comm[0] == '(' && comm[len - 1] == ')') {
-        comm[len - 1] = '\0'; // Supprimer la parenthèse fermante
-        strncpy(info->name, comm + 1, sizeof(info->name) - 1); // Copier sans la parenthèse ouvrante
-    } else {
-        strncpy(info->name, comm, sizeof(info->name));
-    }
+    const char *p = buf;
+    int pid = (int)parse_long(&p);
 
-    info->name[sizeof(info->name) - 1] = '\0'; // S'assurer que la chaîne est terminée
-    
+    *comm = open_par + 1;
+    *comm_len = close_par - open_par - 1;
+
+    p = close_par + 1;
+    while (*p == ' ') p++;
+    char state = *p++;                          // 3e champ
+    int ppid = (int)parse_long(&p);             // 4e champ
+
+    p = skip_fields(p, 9);                      // 5e à 13e champs
+    unsigned long utime = parse_long(&p);       // 14e champ : temps CPU utilisateur
+    unsigned long stime = parse_long(&p);       // 15e champ : temps CPU noyau
+    p = skip_fields(p, 2);                      // 16e et 17e champs
+    long priority = parse_long(&p);             // 18e champ
+    long nice = parse_long(&p);                 // 19e champ
+    long num_threads = parse_long(&p);          // 20e champ
+    p = skip_fields(p, 1);                      // 21e champ
+    *starttime = (unsigned long long)parse_long(&p); // 22e champ : démarrage, en ticks depuis le boot
+    p = skip_fields(p, 16);                     // 23e à 38e champs
+    while (*p == ' ') p++;
+    int last_cpu = (*p >= '0' && *p <= '9') ? (int)parse_long(&p) : -1; // 39e champ : processor
+
+    info->pid = pid;
+    info->tgid = pid;
+    info->ppid = ppid;
     info->state = state;
     info->priority = priority;
     info->nice = nice;
+    info->num_threads = (int)num_threads;
     info->time = utime + stime;
+    info->last_cpu = last_cpu;
+    info->numa_node = sysstats_cpu_node(last_cpu);
+    info->is_thread = 0;
+    info->depth = 0;
+    info->tree_mask = 0;
+    info->children = 0;
 
     return 1;
 }
 
-// Lit /proc/<pid>/statm 
-// Extrait la memoire
-int read_statm(const char *pid_str, ProcessInfo *info, unsigned long mem_total) {
-    char path[256];
-    FILE *f;
-    snprintf(path, sizeof(path), "/proc/%s/statm", pid_str); // construction du chemin du fichier
-    f = fopen(path, "r");
-    if (!f) return 0;
+int parse_stat(const char *buf, ProcessInfo *info) {
+    const char *comm;
+    size_t len;
+    unsigned long long starttime;
+    if (!parse_stat_fields(buf, info, &comm, &len, &starttime)) return 0;
+    info->name_id = strpool_intern(comm, len);
+    return 1;
+}
+
+// Idem pour un pid suivi : le nom n'est réinterné que s'il a changé depuis
+// la lecture précédente (une comparaison au lieu d'un hachage). Un pid
+// réattribué entre deux balayages (autre date de démarrage) repart d'un état
+// neuf : ni le temps CPU, ni le cgroup, ni les refus d'accès du précédent.
+static int parse_stat_cached(const char *buf, ProcessInfo *info, PidTable *table, PidState *st) {
+    const char *comm;
+    size_t len;
+    unsigned long long starttime;
+    if (!parse_stat_fields(buf, info, &comm, &len, &starttime)) return 0;
+    if (st->start_known && st->starttime != starttime) pidtable_renew(table, st);
+    st->starttime = starttime;
+    st->start_known = 1;
+    if (len == strpool_len(st->name_id) && memcmp(strpool_get(st->name_id), comm, len) == 0) {
+        strpool_touch(st->name_id);
+    } else {
+        st->name_id = strpool_intern(comm, len);
+    }
+    info->name_id = st->name_id;
+    return 1;
+}
 
-    unsigned long size, resident, shared;
+// Lit /proc/<pid>/stat
+// Extrait le PID, nom, état, temps CPU, priorité, nice
+int read_stat(const char *pid_str, ProcessInfo *info) {
+    char path[512];
+    char buf[1024];
+    snprintf(path, sizeof(path), "%s/%s/stat", proc_root, pid_str); // Construit le chemin du fichier du processus
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) return 0;
+    return parse_stat(buf, info);
+}
+
+// Parseur de /proc/<pid>/statm à partir d'un tampon déjà lu
+static int parse_statm(const char *buf, ProcessInfo *info, unsigned long mem_total) {
     // statm contient 6 champs, on ne lit que les 3 premiers
     // size : memmoire virtuelle totale
     // resident : RAM
-    if (fscanf(f, "%lu %lu %lu", &size, &resident, &shared) != 3) {
-        fclose(f);
-        return 0;
-    }
-    fclose(f);
+    const char *p = buf;
+    unsigned long size = parse_long(&p);
+    unsigned long resident = parse_long(&p);
+    unsigned long shared = parse_long(&p);
+    if (*p != ' ') return 0;
 
     // /proc/statm donne des nombres de pages, pas des octets donc on convertit en octets
-    long page_size = sysconf(_SC_PAGESIZE);
+    static long page_size = 0;
+    if (page_size == 0) page_size = sysconf(_SC_PAGESIZE);
     info->virt = size * page_size;
     info->res  = resident * page_size;
     info->shr  = shared * page_size;
@@ -99,62 +171,201 @@ int read_statm(const char *pid_str, ProcessInfo *info, unsigned long mem_total)
     return 1;
 }
 
-// Lit /proc/<pid>/status pour USER
+// Lit /proc/<pid>/statm 
+// Extrait la memoire
+int read_statm(const char *pid_str, ProcessInfo *info, unsigned long mem_total) {
+    char path[512];
+    char buf[256];
+    snprintf(path, sizeof(path), "%s/%s/statm", proc_root, pid_str); // construction du chemin du fichier
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) return 0;
+    return parse_statm(buf, info, mem_total);
+}
+
+// uid -> nom interné : getpwuid n'est appelé qu'une fois par uid (cache à
+// correspondance directe, un uid évincé est simplement relu)
+#define UID_CACHE_SIZE 256
+static struct { unsigned int uid_plus1; int id; } uid_cache[UID_CACHE_SIZE];
+
+static int user_name(unsigned int uid) {
+    unsigned int slot = uid & (UID_CACHE_SIZE - 1);
+    if (uid_cache[slot].uid_plus1 == uid + 1 && strpool_valid(uid_cache[slot].id)) {
+        strpool_touch(uid_cache[slot].id);
+        return uid_cache[slot].id;
+    }
+    char name[64];
+    prof_start(PROF_USERS);
+    struct passwd *pw = getpwuid(uid); // conversion
+    prof_stop(PROF_USERS);
+    int len = pw ? snprintf(name, sizeof(name), "%s", pw->pw_name) // si utilisateur trouvé alors on donne le nom
+                 : snprintf(name, sizeof(name), "%u", uid);         // sinon UID brut
+    if (len >= (int)sizeof(name)) len = sizeof(name) - 1;
+    uid_cache[slot].uid_plus1 = uid + 1;
+    uid_cache[slot].id = strpool_intern(name, len);
+    return uid_cache[slot].id;
+}
+
+// Lit /proc/<pid>/status pour USER, et les coeurs autorisés dans la même lecture
 int read_user(const char *pid_str, ProcessInfo *info) {
-    char path[256];
-    FILE *f;
-    snprintf(path, sizeof(path), "/proc/%s/status", pid_str);
-    f = fopen(path, "r");
-    if (!f) return 0;
-
-    char line[256];
-    int uid = -1;
-    
-    while (fgets(line, sizeof(line), f)) { // lire ligne par ligne
-        if (strncmp(line, "Uid:", 4) == 0) { // compare les 4 1er caractères
-            if (sscanf(line, "Uid: %d", &uid) == 1) {
-                struct passwd *pw = getpwuid(uid); // conversion
-                if (pw) {
-                    strncpy(info->user, pw->pw_name, sizeof(info->user)); // si utilisateur trouvé alors on donne le nom
-                } else {
-                    snprintf(info->user, sizeof(info->user), "%u", uid); // sinon UID brut
-                }
-                info->user[sizeof(info->user) - 1] = '\0'; //sécurité mémoire
-            }
-            break;
-        }
+    char path[512];
+    char buf[4096];
+    snprintf(path, sizeof(path), "%s/%s/status", proc_root, pid_str);
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) return 0;
+
+    const char *line = strstr(buf, "\nUid:"); // une seule lecture, puis recherche de la ligne
+    if (!line) return 0;
+    const char *p = line + 5;
+    while (*p == '\t' || *p == ' ') p++;
+    if (*p < '0' || *p > '9') return 0;
+    unsigned int uid = (unsigned int)parse_long(&p);
+
+    info->user_id = user_name(uid);
+    // même masque pour presque tous les processus : une seule chaîne dans le pool
+    const char *cpus = strstr(line, "\nCpus_allowed_list:");
+    info->affinity_id = 0;
+    if (cpus) {
+        cpus += 19;
+        while (*cpus == '\t' || *cpus == ' ') cpus++;
+        info->affinity_id = strpool_intern(cpus, strcspn(cpus, "\n"));
+    }
+    return 1;
+}
+
+// Ligne de commande (arguments séparés par des espaces), lue une fois par vie
+// de pid : relue seulement si comm a changé depuis (exec) ou si la chaîne a
+// quitté le pool. Vide pour un thread noyau.
+static void read_cmdline(const char *pid_str, ProcessInfo *info, PidState *st) {
+    if (st->cmd_name == info->name_id && strpool_valid(st->cmd_id)) {
+        strpool_touch(st->cmd_id);
+        info->cmd_id = st->cmd_id;
+        return;
+    }
+    char path[512], buf[CMDLINE_MAX];
+    snprintf(path, sizeof(path), "%s/%s/cmdline", proc_root, pid_str);
+    int n = pidtable_read_once(path, buf, sizeof(buf));
+    if (n < 0) n = 0;
+    while (n > 0 && buf[n - 1] == '\0') n--;
+    for (int i = 0; i < n; i++) {
+        if (buf[i] == '\0' || buf[i] == '\n' || buf[i] == '\t') buf[i] = ' ';
+        else if ((unsigned char)buf[i] < 0x20) buf[i] = '?'; // pas de séquences de contrôle à l'écran
+    }
+    st->cmd_id = strpool_intern(buf, n);
+    st->cmd_name = info->name_id;
+    info->cmd_id = st->cmd_id;
+}
+
+
+// Lit /proc/<pid>/io (octets lus/écrits sur disque) et calcule les débits
+// par rapport à la mesure précédente gardée dans l'état du pid.
+// Le fichier n'est lisible que pour ses propres processus (ou root) : un refus
+// est mémorisé pour ne pas retenter l'ouverture à chaque rafraîchissement.
+static void read_io(const char *pid_str, ProcessInfo *info, PidState *st, double now) {
+    info->io_valid = 0;
+    info->io_read_rate = info->io_write_rate = 0.0;
+    if (st->io_denied) return;
+
+    char path[512], buf[512];
+    snprintf(path, sizeof(path), "%s/%s/io", proc_root, pid_str);
+    if (pidtable_read(&st->io_fd, path, buf, sizeof(buf)) <= 0) {
+        if (errno == EACCES || errno == EPERM) st->io_denied = 1;
+        return;
     }
-    fclose(f);
-    return uid != -1; // Retourne vrai si l'UID a été trouvé
+
+    const char *rb = strstr(buf, "\nread_bytes:");
+    const char *wb = strstr(buf, "\nwrite_bytes:");
+    if (!rb || !wb) return;
+    rb += 12;
+    wb += 13;
+    unsigned long long read_bytes = (unsigned long long)parse_long(&rb);
+    unsigned long long write_bytes = (unsigned long long)parse_long(&wb);
+
+    if (st->prev_io_time > 0 && now > st->prev_io_time) {
+        double elapsed = now - st->prev_io_time;
+        info->io_read_rate = (read_bytes >= st->prev_read_bytes) ? (read_bytes - st->prev_read_bytes) / elapsed : 0.0;
+        info->io_write_rate = (write_bytes >= st->prev_write_bytes) ? (write_bytes - st->prev_write_bytes) / elapsed : 0.0;
+    }
+    info->io_valid = 1;
+    st->prev_read_bytes = read_bytes;
+    st->prev_write_bytes = write_bytes;
+    st->prev_io_time = now;
+}
+
+// /proc/<pid>/schedstat : "temps_cpu_ns attente_ns tranches". Comme pour le
+// CPU%, le délai est l'attente cumulée depuis la mesure précédente rapportée
+// au temps écoulé. Le fichier ne décrit que le thread principal : une lecture
+// par pid, comme stat (les threads ont leur propre ligne en mode thread).
+static void account_sched(const char *buf, ProcessInfo *info, PidState *st, double now) {
+    const char *p = buf;
+    parse_long(&p); // temps CPU, déjà connu par stat
+    unsigned long long wait_ns = (unsigned long long)parse_long(&p);
+
+    info->sched_valid = 0;
+    info->sched_delay = 0.0;
+    if (st->prev_sched_time > 0 && now > st->prev_sched_time && wait_ns >= st->prev_wait_ns) {
+        info->sched_delay = 100.0 * (wait_ns - st->prev_wait_ns) / 1e9 / (now - st->prev_sched_time);
+        info->sched_valid = 1;
+    }
+    st->prev_wait_ns = wait_ns;
+    st->prev_sched_time = now;
+}
+
+// Sans COLLECT_SCHED : rien à lire, le délai repartira d'une mesure fraîche
+static void skip_sched(ProcessInfo *info, PidState *st) {
+    info->sched_valid = 0;
+    info->sched_delay = 0.0;
+    st->prev_sched_time = 0;
+}
+
+static void read_sched(const char *path, ProcessInfo *info, PidState *st, double now) {
+    char buf[128];
+    if (pidtable_read(&st->sched_fd, path, buf, sizeof(buf)) <= 0) {
+        skip_sched(info, st); // noyau sans CONFIG_SCHED_INFO ou pid terminé
+        return;
+    }
+    account_sched(buf, info, st, now);
 }
 
+// Lit /proc/<pid>/smaps_rollup (noyau >= 4.14) dans le cache du pid.
+// Le noyau parcourt toutes les tables de pages du processus : plusieurs
+// millisecondes pour un gros processus, d'où le cache et la lecture différée.
+// Illisible (autre utilisateur, thread noyau sans mémoire) : mémorisé, pas de nouvel essai.
+static void read_smaps(const char *pid_str, PidState *st, double now) {
+    char path[512], buf[2048];
+    snprintf(path, sizeof(path), "%s/%s/smaps_rollup", proc_root, pid_str);
+    st->smaps_time = now;
+    if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) {
+        st->smaps_state = -1;
+        return;
+    }
+    static const char *keys[] = { "\nPss:", "\nPrivate_Clean:", "\nPrivate_Dirty:", "\nSwap:" };
+    unsigned long kb[4];
+    for (int i = 0; i < 4; i++) {
+        const char *p = strstr(buf, keys[i]);
+        if (!p) { st->smaps_state = -1; return; }
+        p += strlen(keys[i]);
+        kb[i] = (unsigned long)parse_long(&p);
+    }
+    st->pss = kb[0] * 1024;
+    st->uss = (kb[1] + kb[2]) * 1024;
+    st->swap = kb[3] * 1024;
+    st->smaps_state = 1;
+}
+
+static void copy_smaps(ProcessInfo *info, const PidState *st) {
+    info->smaps_valid = (st->smaps_state == 1);
+    info->pss = st->pss;
+    info->uss = st->uss;
+    info->swap = st->swap;
+}
 
 // get_mem_total
+// MemTotal ne change pas : on réutilise la valeur lue par le module sysstats
 unsigned long process_get_mem_total() {
-    FILE *f = fopen("/proc/meminfo", "r");
-    if (!f) return 0;
-    char label[64];
-    unsigned long mem_total_kb = 0;
-    while (fscanf(f, "%63s %lu", label, &mem_total_kb) == 2) { //lecture fichier ligne par ligne
-        if (strcmp(label, "MemTotal:") == 0) break; // jusqu'à trouver la ligne correspondante
-    }
-    fclose(f);
-    return mem_total_kb * 1024; // Convertir KiB en octets
+    return sysstats_mem_total();
 }
 
 // get_total_cpu_time 
 unsigned long long process_get_total_cpu_time() {
-    FILE *f = fopen("/proc/stat", "r");
-    if (!f) return 0;
-    char cpu[5];
-    unsigned long long user=0, nice=0, system=0, idle=0, iowait=0, irq=0, softirq=0, steal=0;
-    if (fscanf(f, "%s %llu %llu %llu %llu %llu %llu %llu %llu",
-           cpu, &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) != 9) {
-        fclose(f);
-        return 0;
-    }
-    fclose(f);
-    return user + nice + system + idle + iowait + irq + softirq + steal;
+    return sysstats_read_cpu_total();
 }
 
 // calculate_cpu_percent entre 2 mesures
@@ -197,70 +408,675 @@ int compare_mem(const void *a, const void *b) {
     return 0; // Les pourcentages sont égaux
 }
 
-// initial_scan 
-// Initialiser le point de référence pour le calcul de l'utilisation CPU.
-void process_initial_scan(unsigned long prev_proc_times[]) {
-    DIR *dir = opendir("/proc");
-    if (!dir) { perror("opendir initial_scan"); return; }
+//Fonction de comparaison pour qsort pour trier par débit de lecture disque (décroissant)
+int compare_io_read(const void *a, const void *b) {
+    const ProcessInfo *info_a = (const ProcessInfo *)a;
+    const ProcessInfo *info_b = (const ProcessInfo *)b;
+
+    if (info_a->io_read_rate < info_b->io_read_rate) return 1;
+    if (info_a->io_read_rate > info_b->io_read_rate) return -1;
+    return 0;
+}
+
+//Fonction de comparaison pour qsort pour trier par débit d'écriture disque (décroissant)
+int compare_io_write(const void *a, const void *b) {
+    const ProcessInfo *info_a = (const ProcessInfo *)a;
+    const ProcessInfo *info_b = (const ProcessInfo *)b;
+
+    if (info_a->io_write_rate < info_b->io_write_rate) return 1;
+    if (info_a->io_write_rate > info_b->io_write_rate) return -1;
+    return 0;
+}
+
+// ----------- liste de pids -----------------
+
+// Pids d'un balayage (readdir en io_uring, ou mode surveillance), relus ensuite
+// un par un ou par lots
+static int *scan_pids = NULL;
+static int scan_count = 0;
+static int scan_cap = 0;
+
+static int scan_push(int pid) {
+    if (scan_count == scan_cap) {
+        int cap = scan_cap ? scan_cap * 2 : 4096;
+        int *pids = realloc(scan_pids, sizeof(int) * cap);
+        if (!pids) return 0;
+        scan_pids = pids;
+        scan_cap = cap;
+    }
+    scan_pids[scan_count++] = pid;
+    return 1;
+}
+
+static int scan_proc_dir(DIR *dir) {
     struct dirent *entry;
+    scan_count = 0;
     while ((entry = readdir(dir)) != NULL) {
-        if (is_pid(entry->d_name)) {
-            ProcessInfo info = {0};
-            if (read_stat(entry->d_name, &info)) {
-                if (info.pid < MAX_PID) {
-                    prev_proc_times[info.pid] = info.time; // stock le nombre de tick
-                }
-            }
+        if (is_pid(entry->d_name) && !scan_push(atoi(entry->d_name))) break;
+    }
+    return scan_count;
+}
+
+// ----------- mode surveillance (--pid, --pidfile) -----------------
+
+// Pids suivis sans balayer /proc : donnés directement, lus dans des fichiers
+// de pid (relus à chaque collecte, le service a pu redémarrer) et, en option,
+// leurs descendants
+static int watch_pids[MAX_WATCH];
+static int watch_npids = 0;
+static char watch_files[MAX_WATCH][WATCH_PATH_MAX];
+static int watch_nfiles = 0;
+static int watch_descendants = 0;
+
+int process_watch_pid(int pid) {
+    if (pid <= 0 || watch_npids >= MAX_WATCH) return -1;
+    watch_pids[watch_npids++] = pid;
+    return 0;
+}
+
+int process_watch_pidfile(const char *path) {
+    if (watch_nfiles >= MAX_WATCH || strlen(path) >= WATCH_PATH_MAX) return -1;
+    strcpy(watch_files[watch_nfiles++], path);
+    return 0;
+}
+
+void process_watch_descendants(int enable) {
+    watch_descendants = enable;
+}
+
+int process_watch_active(void) {
+    return watch_npids > 0 || watch_nfiles > 0;
+}
+
+// Ajoute un pid à la liste du balayage en cours (pidtable_begin() déjà appelé) :
+// l'epoch de son entrée sert à ne pas le lister deux fois
+static void watch_push(PidTable *table, int pid) {
+    PidState *st = pidtable_find(table, pid);
+    if (st && st->epoch == table->epoch) return;
+    if (pidtable_get(table, pid)) scan_push(pid);
+}
+
+// Enfants d'un processus : /proc/<pid>/task/<tid>/children de chacun de ses
+// threads (un fils appartient au thread qui l'a créé)
+static void watch_push_children(PidTable *table, int pid) {
+    char path[512], buf[4096];
+    snprintf(path, sizeof(path), "%s/%d/task", proc_root, pid);
+    DIR *dir = opendir(path);
+    PROF_OPEN();
+    if (!dir) return;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!is_pid(entry->d_name)) continue;
+        snprintf(path, sizeof(path), "%s/%d/task/%s/children", proc_root, pid, entry->d_name);
+        if (pidtable_read_once(path, buf, sizeof(buf)) <= 0) continue; // vide : pas d'enfant
+        const char *p = buf;
+        while (*p) {
+            long child = parse_long(&p);
+            if (child > 0) watch_push(table, (int)child);
+            while (*p && (*p < '0' || *p > '9')) p++;
         }
     }
     closedir(dir);
 }
 
+static int watch_build_list(PidTable *table) {
+    char buf[32];
+    scan_count = 0;
+    for (int i = 0; i < watch_npids; i++) watch_push(table, watch_pids[i]);
+    for (int i = 0; i < watch_nfiles; i++) {
+        if (pidtable_read_once(watch_files[i], buf, sizeof(buf)) <= 0) continue; // service arrêté
+        int pid = atoi(buf);
+        if (pid > 0) watch_push(table, pid);
+    }
+    // parcours en largeur : la liste grandit pendant qu'on la parcourt
+    if (watch_descendants) {
+        for (int i = 0; i < scan_count; i++) watch_push_children(table, scan_pids[i]);
+    }
+    return scan_count;
+}
+
+//Fonction de comparaison pour qsort pour trier par délai d'ordonnancement (décroissant)
+int compare_delay(const void *a, const void *b) {
+    const ProcessInfo *info_a = (const ProcessInfo *)a;
+    const ProcessInfo *info_b = (const ProcessInfo *)b;
+
+    if (info_a->sched_delay < info_b->sched_delay) return 1;
+    if (info_a->sched_delay > info_b->sched_delay) return -1;
+    return 0;
+}
+
+//Fonction de comparaison pour qsort pour trier par PSS (décroissant), valeurs en cache
+int compare_pss(const void *a, const void *b) {
+    const ProcessInfo *info_a = (const ProcessInfo *)a;
+    const ProcessInfo *info_b = (const ProcessInfo *)b;
+
+    if (info_a->pss < info_b->pss) return 1;
+    if (info_a->pss > info_b->pss) return -1;
+    return 0;
+}
+
+// initial_scan 
+// Initialiser le point de référence pour le calcul de l'utilisation CPU.
+static void prime_pid(PidTable *table, const char *pid_str) {
+    char path[512], buf[1024];
+    PidState *st = pidtable_get(table, atoi(pid_str));
+    if (!st) return;
+    ProcessInfo info = {0};
+    snprintf(path, sizeof(path), "%s/%s/stat", proc_root, pid_str);
+    if (pidtable_read(&st->stat_fd, path, buf, sizeof(buf)) > 0 && parse_stat_cached(buf, &info, table, st)) {
+        st->prev_time = info.time; // stock le nombre de tick
+        st->samples++;
+    }
+}
+
+void process_initial_scan(PidTable *table) {
+    pidtable_begin(table);
+    if (process_watch_active()) {
+        char pid_str[16];
+        int n = watch_build_list(table);
+        for (int i = 0; i < n; i++) {
+            snprintf(pid_str, sizeof(pid_str), "%d", scan_pids[i]);
+            prime_pid(table, pid_str);
+        }
+    } else {
+        DIR *dir = opendir(proc_root);
+        if (!dir) { perror("opendir initial_scan"); return; }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (is_pid(entry->d_name)) prime_pid(table, entry->d_name);
+        }
+        closedir(dir);
+    }
+    pidtable_sweep(table);
+}
+
+static int (*sort_compare(SortMode mode))(const void *, const void *) {
+    if (mode == SORT_MEM) return compare_mem;
+    if (mode == SORT_IO_READ) return compare_io_read;
+    if (mode == SORT_IO_WRITE) return compare_io_write;
+    if (mode == SORT_PSS) return compare_pss;
+    if (mode == SORT_DELAY) return compare_delay;
+    return compare_cpu;
+}
+
 // Nouvelle fonction de tri
 void process_sort(ProcessInfo processes[], int count, SortMode mode) { 
-    if (mode == SORT_CPU) { 
-        qsort(processes, count, sizeof(ProcessInfo), compare_cpu);
-    } else if (mode == SORT_MEM) { 
-        qsort(processes, count, sizeof(ProcessInfo), compare_mem);
+    qsort(processes, count, sizeof(ProcessInfo), sort_compare(mode));
+}
+
+static void swap_info(ProcessInfo *a, ProcessInfo *b) {
+    ProcessInfo tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+// process_sort_top
+// Sélection rapide (partition de Hoare) jusqu'à ce que les k premiers soient
+// les k plus grands, puis tri de ces k seulement : O(n + k log k)
+void process_sort_top(ProcessInfo processes[], int count, SortMode mode, int k) {
+    if (k <= 0 || k >= count) {
+        process_sort(processes, count, mode);
+        return;
     }
+    int (*cmp)(const void *, const void *) = sort_compare(mode);
+    int lo = 0, hi = count - 1;
+    while (lo < hi) {
+        ProcessInfo pivot = processes[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (cmp(&processes[i], &pivot) < 0) i++;
+            while (cmp(&processes[j], &pivot) > 0) j--;
+            if (i <= j) swap_info(&processes[i++], &processes[j--]);
+        }
+        // [lo, j] passe avant le pivot, [i, hi] après : on ne garde que le côté de k
+        if (k - 1 <= j) hi = j;
+        else if (k - 1 >= i) lo = i;
+        else break;
+    }
+    qsort(processes, k, sizeof(ProcessInfo), cmp);
+}
+
+// process_fill_rows
+// Champs différés par la collecte (voir COLLECT_MEM / COLLECT_USER), lus pour
+// quelques lignes seulement. Un pid disparu entre-temps garde des champs vides.
+void process_fill_rows(ProcessInfo rows[], int count) {
+    unsigned long mem_total = 0;
+    char pid_str[16];
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *info = &rows[i];
+        if (!info->missing) continue;
+        snprintf(pid_str, sizeof(pid_str), "%d", info->pid);
+        if (info->missing & COLLECT_MEM) {
+            if (mem_total == 0) mem_total = process_get_mem_total();
+            read_statm(pid_str, info, mem_total);
+        }
+        if ((info->missing & COLLECT_USER) && !read_user(pid_str, info)) {
+            info->user_id = strpool_intern("?", 1);
+        }
+        info->missing = 0;
+    }
+}
+
+// process_smaps_update
+// Appelée avant le rendu pour la page affichée (only_missing), et pendant
+// l'attente entre deux trames pour rafraîchir le cache par petites tranches
+int process_smaps_update(PidTable *table, ProcessInfo rows[], int count,
+                         int only_missing, double budget_ms) {
+    static int cursor = 0; // reprise de la tranche de fond suivante
+    if (count <= 0) return 0;
+    if (cursor >= count) cursor = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = ts.tv_sec + ts.tv_nsec / 1e9;
+    double deadline = now + budget_ms / 1000.0;
+    char pid_str[16];
+    int first = only_missing ? 0 : cursor;
+    int reads = 0, n;
+    for (n = 0; n < count; n++) {
+        ProcessInfo *info = &rows[(first + n) % count];
+        if (info->is_thread) continue;
+        PidState *st = pidtable_find(table, info->pid);
+        if (!st || st->smaps_state < 0) continue;
+        int stale = (st->smaps_state == 0) ||
+                    (!only_missing && now - st->smaps_time >= SMAPS_INTERVAL);
+        if (stale) {
+            if (reads > 0 && now >= deadline) break;
+            snprintf(pid_str, sizeof(pid_str), "%d", info->pid);
+            read_smaps(pid_str, st, now);
+            reads++;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            now = ts.tv_sec + ts.tv_nsec / 1e9;
+        }
+        copy_smaps(info, st);
+    }
+    if (!only_missing) cursor = (first + n) % count;
+    return reads;
+}
+
+// ----------- lectures groupées (io_uring) -----------------
+
+// Lecteur io_uring actif (process_set_io_uring)
+static int use_uring = 0;
+
+int process_set_io_uring(int enable) {
+    if (!enable) {
+        uring_close();
+        use_uring = 0;
+        return 0;
+    }
+    use_uring = (uring_init() == 0);
+    return use_uring;
+}
+
+// Tampons d'un lot : stat (et schedstat) de tous les pids du lot, statm des survivants au filtre
+static char batch_stat[URING_ENTRIES][1024];
+static char batch_sched[URING_ENTRIES][128];
+static char batch_statm[URING_ENTRIES][256];
+static UringRead batch_reqs[2 * URING_ENTRIES];
+static int batch_req[URING_ENTRIES];          // requête du pid i, -1 : pas de descripteur en cache
+static int batch_sched_req[URING_ENTRIES];    // idem pour schedstat
+static PidState *batch_st[URING_ENTRIES];
+
+// Lit un fichier par lot quand le descripteur est en cache, sinon (pid
+// nouveau, pid terminé, anneau en échec) par pidtable_read qui l'ouvre.
+// Retourne > 0 si buf contient le fichier.
+static int batch_result(int req, int *fd, const char *pid_str, const char *file, char *buf, int size) {
+    if (req >= 0 && batch_reqs[req].result > 0) return batch_reqs[req].result;
+    if (req >= 0) pidtable_close_fd(fd); // descripteur périmé : rouvert ci-dessous
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/%s", proc_root, pid_str, file);
+    return pidtable_read(fd, path, buf, size);
+}
+
+static void batch_submit(int nreq) {
+    if (nreq > 0 && uring_read_batch(batch_reqs, nreq) != 0) {
+        use_uring = 0; // anneau inutilisable : retour définitif à pread
+        for (int i = 0; i < nreq; i++) batch_reqs[i].result = -1;
+    }
+}
+
+// ----------- collecte -----------------
+
+// CPU% et premier niveau de filtre, communs aux deux chemins de lecture
+static int account_stat(ProcessInfo *info, PidState *st, const Filter *filter,
+                        unsigned long long prev_total_cpu, unsigned long long current_total_cpu) {
+    info->cpu_percent = (st->samples > 0)
+        ? calculate_cpu_percent(info->time, st->prev_time, current_total_cpu, prev_total_cpu)
+        : 0.0;
+    st->prev_time = info->time; // met à jour temps CPU (même si le processus est filtré)
+    st->samples++;
+
+    // Le filtre est évalué au plus tôt : un pid rejeté sur son nom ou son
+    // CPU% ne coûte pas les lectures de statm et status
+    return filter_match(filter, info, FILTER_STAGE_STAT);
+}
+
+// Fin de collecte d'un pid dont stat (et statm si demandé) sont lus : status, io, cgroup
+static int finish_process(const char *pid_str, ProcessInfo *info, PidState *st,
+                          const Filter *filter, int flags, double now) {
+    if (!(flags & COLLECT_MEM)) {
+        info->virt = info->res = info->shr = 0;
+        info->mem_percent = 0.0;
+    }
+    if (flags & COLLECT_USER) {
+        if (!read_user(pid_str, info) ||
+            !filter_match(filter, info, FILTER_STAGE_USER)) return 0;
+    } else {
+        info->user_id = 0;
+        info->affinity_id = 0;
+    }
+    read_cmdline(pid_str, info, st);
+    info->missing = COLLECT_FIELDS & ~flags;
+    info->alert = 0; // posé ensuite par alert_evaluate()
+    if (flags & COLLECT_SMAPS) copy_smaps(info, st);
+    else info->smaps_valid = 0;
+
+    // /proc/<pid>/io est coûteux et restreint : lu seulement si utile
+    if (flags & COLLECT_IO) {
+        read_io(pid_str, info, st, now);
+    } else {
+        info->io_valid = 0;
+        st->prev_io_time = 0; // les débits repartiront d'une mesure fraîche
+    }
+
+    // Le cgroup d'un processus ne change presque jamais : lu une fois, puis
+    // touché à chaque collecte pour que son chemin reste dans le pool. Relu
+    // après un échec ou si le chemin a quitté le pool (vue quittée plus de STRPOOL_TTL)
+    if (flags & COLLECT_CGROUP) {
+        if (st->cgroup_id > 0 && strpool_valid(st->cgroup_id)) strpool_touch(st->cgroup_id);
+        else st->cgroup_id = cgroup_lookup_pid(pid_str);
+    }
+    info->cgroup_id = st->cgroup_id;
+    return 1;
+}
+
+// Chemin io_uring : les pids de la liste sont relus par lots de
+// URING_ENTRIES, un io_uring_enter pour les stat (et schedstat) du lot puis un pour les
+// statm des pids retenus par le filtre (si COLLECT_MEM). status, io et cgroup restent lus un
+// par un. Remplit processes[] dans l'ordre de la liste, comme le chemin pread.
+static int collect_batched(const int all_pids[], int npids, ProcessInfo processes[], int max_count,
+                           unsigned long long prev_total_cpu, PidTable *table,
+                           unsigned long long current_total_cpu, int flags,
+                           unsigned long mem_total, double now) {
+    const Filter *filter = filter_get_active();
+    int count = 0;
+    char pid_str[16];
+    for (int start = 0; start < npids && count < max_count; ) {
+        // un lot ne dépasse jamais la place restante : aucun pid lu n'est perdu
+        int n = npids - start;
+        if (n > URING_ENTRIES) n = URING_ENTRIES;
+        if (n > max_count - count) n = max_count - count;
+        const int *pids = all_pids + start;
+        start += n;
+
+        // Les entrées peuvent bouger quand la table grandit : pointeurs pris
+        // une fois tous les pids du lot insérés
+        for (int i = 0; i < n; i++) pidtable_get(table, pids[i]);
+        int nreq = 0;
+        for (int i = 0; i < n; i++) {
+            PidState *st = batch_st[i] = pidtable_find(table, pids[i]);
+            batch_req[i] = batch_sched_req[i] = -1;
+            if (st && st->stat_fd >= 0 && use_uring) {
+                batch_reqs[nreq] = (UringRead){ st->stat_fd, batch_stat[i], sizeof(batch_stat[i]), -1 };
+                batch_req[i] = nreq++;
+            }
+            // schedstat part dans le même io_uring_enter que stat
+            if ((flags & COLLECT_SCHED) && st && st->sched_fd >= 0 && use_uring) {
+                batch_reqs[nreq] = (UringRead){ st->sched_fd, batch_sched[i], sizeof(batch_sched[i]), -1 };
+                batch_sched_req[i] = nreq++;
+            }
+        }
+        batch_submit(nreq);
+
+        // stat : CPU% et filtre, les pids retenus sont tassés en tête de processes[count..]
+        int kept = 0;
+        for (int i = 0; i < n; i++) {
+            PidState *st = batch_st[i];
+            if (!st) continue;
+            snprintf(pid_str, sizeof(pid_str), "%d", pids[i]);
+            ProcessInfo *info = &processes[count + kept];
+            if (batch_result(batch_req[i], &st->stat_fd, pid_str, "stat",
+                             batch_stat[i], sizeof(batch_stat[i])) <= 0 ||
+                !parse_stat_cached(batch_stat[i], info, table, st)) continue;
+            if (!account_stat(info, st, filter, prev_total_cpu, current_total_cpu)) continue;
+            if (!(flags & COLLECT_SCHED)) skip_sched(info, st);
+            else if (batch_result(batch_sched_req[i], &st->sched_fd, pid_str, "schedstat",
+                                  batch_sched[i], sizeof(batch_sched[i])) > 0) account_sched(batch_sched[i], info, st, now);
+            else skip_sched(info, st);
+            batch_st[kept++] = st;
+        }
+
+        nreq = 0;
+        for (int k = 0; k < kept; k++) {
+            PidState *st = batch_st[k];
+            batch_req[k] = -1;
+            if ((flags & COLLECT_MEM) && st->statm_fd >= 0 && use_uring) {
+                batch_reqs[nreq] = (UringRead){ st->statm_fd, batch_statm[k], sizeof(batch_statm[k]), -1 };
+                batch_req[k] = nreq++;
+            }
+        }
+        batch_submit(nreq);
+
+        int base = count;
+        for (int k = 0; k < kept; k++) {
+            PidState *st = batch_st[k];
+            ProcessInfo *info = &processes[base + k];
+            snprintf(pid_str, sizeof(pid_str), "%d", st->pid);
+            if ((flags & COLLECT_MEM) &&
+                (batch_result(batch_req[k], &st->statm_fd, pid_str, "statm",
+                              batch_statm[k], sizeof(batch_statm[k])) <= 0 ||
+                 !parse_statm(batch_statm[k], info, mem_total) ||
+                 !filter_match(filter, info, FILTER_STAGE_STATM))) continue;
+            if (!finish_process(pid_str, info, st, filter, flags, now)) continue;
+            if (&processes[count] != info) processes[count] = *info;
+            count++;
+        }
+    }
+    return count;
+}
+
+// Chemin pread : un pid lu fichier par fichier. Retourne 1 si info est à garder.
+static int collect_one(const char *pid_str, ProcessInfo *info, PidTable *table,
+                       const Filter *filter, int flags,
+                       unsigned long long prev_total_cpu, unsigned long long current_total_cpu,
+                       unsigned long mem_total, double now) {
+    char path[512], buf[1024];
+    PidState *st = pidtable_get(table, atoi(pid_str));
+    if (!st) return 0;
+
+    // /proc/<pid>/stat est relu via le descripteur gardé en cache
+    snprintf(path, sizeof(path), "%s/%s/stat", proc_root, pid_str);
+    if (pidtable_read(&st->stat_fd, path, buf, sizeof(buf)) <= 0 ||
+        !parse_stat_cached(buf, info, table, st)) return 0; //récupere les infos utiles
+
+    if (!account_stat(info, st, filter, prev_total_cpu, current_total_cpu)) return 0;
+    if (flags & COLLECT_SCHED) {
+        snprintf(path, sizeof(path), "%s/%s/schedstat", proc_root, pid_str);
+        read_sched(path, info, st, now);
+    } else {
+        skip_sched(info, st);
+    }
+    if ((flags & COLLECT_MEM) &&
+        (!read_statm(pid_str, info, mem_total) ||
+         !filter_match(filter, info, FILTER_STAGE_STATM))) return 0;
+    return finish_process(pid_str, info, st, filter, flags, now);
 }
 
 // process_collect_all
 // fonction moteur qui regroupe et qui actualise pour remplir le tableau de structure PorcessInfo
 int process_collect_all(ProcessInfo processes[], int max_count,
                         unsigned long long prev_total_cpu,
-                        unsigned long prev_proc_times[],
-                        unsigned long long current_total_cpu) {
+                        PidTable *table,
+                        unsigned long long current_total_cpu,
+                        int flags) {
 
     unsigned long mem_total = process_get_mem_total(); 
-    DIR *dir = opendir("/proc"); // ouvrre le /proc
-    if (!dir) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = ts.tv_sec + ts.tv_nsec / 1e9; // horodatage commun pour les débits I/O et le délai
+    int watching = process_watch_active(); // pids suivis : pas de balayage de /proc
+    DIR *dir = NULL;
+    if (!watching) {
+        dir = opendir(proc_root); // ouvrre le /proc
+        PROF_OPEN();
+        if (!dir) return 0;
+    }
 
     int count = 0;
     struct dirent *entry;
+    const Filter *filter = filter_get_active();
 
-    while ((entry = readdir(dir)) != NULL && count < max_count) { //parcours le /proc
-        if (is_pid(entry->d_name)) {  // verifie qu'il y a un pid
-            ProcessInfo *info = &processes[count]; //pointeur vers la structure ProcessInfo
+    pidtable_begin(table); // les pids non revus pendant ce balayage seront oubliés
 
-            if (read_stat(entry->d_name, info) && //récupere les infos utiles
-                read_statm(entry->d_name, info, mem_total) &&
-                read_user(entry->d_name, info)) {
+    // Un champ testé par le filtre doit être lu pour tous les pids
+    if (filter->stage_count[FILTER_STAGE_STATM]) flags |= COLLECT_MEM;
+    if (filter->stage_count[FILTER_STAGE_USER]) flags |= COLLECT_USER;
 
-                int pid = info->pid;
-                unsigned long prev_time = prev_proc_times[pid];
+    if (watching || use_uring) {
+        int npids = watching ? watch_build_list(table) : scan_proc_dir(dir);
+        if (use_uring) {
+            count = collect_batched(scan_pids, npids, processes, max_count, prev_total_cpu, table,
+                                    current_total_cpu, flags, mem_total, now);
+        } else {
+            char pid_str[16];
+            for (int i = 0; i < npids && count < max_count; i++) {
+                snprintf(pid_str, sizeof(pid_str), "%d", scan_pids[i]);
+                if (collect_one(pid_str, &processes[count], table, filter, flags,
+                                prev_total_cpu, current_total_cpu, mem_total, now)) count++;
+            }
+        }
+    } else {
+        while ((entry = readdir(dir)) != NULL && count < max_count) { //parcours le /proc
+            if (!is_pid(entry->d_name)) continue; // verifie qu'il y a un pid
+            if (collect_one(entry->d_name, &processes[count], table, filter, flags,
+                            prev_total_cpu, current_total_cpu, mem_total, now)) count++;
+        }
+    }
+    if (dir) closedir(dir);
 
-                info->cpu_percent = calculate_cpu_percent(info->time, prev_time,
-                                                         current_total_cpu, prev_total_cpu);
+    // Index parent -> enfants : mis à jour seulement pour les pids nouveaux ou
+    // réadoptés, une fois tous les parents présents dans la table
+    for (int i = 0; i < count; i++) {
+        PidState *st = pidtable_find(table, processes[i].pid);
+        if (st) pidtable_set_parent(table, st, processes[i].ppid);
+    }
+    pidtable_sweep(table);
+    strpool_collect(); // chaînes des pids disparus depuis STRPOOL_TTL
+    return count;
+}
 
-                if (pid < MAX_PID) {
-                    prev_proc_times[pid] = info->time; // met à jour temps CPU
-                }
+// ----------- mode thread -----------------
 
-                count++;
-            }
+// pids dont l'utilisateur a demandé l'affichage des threads (commande "threads <pid>")
+static int expanded_pids[MAX_EXPANDED];
+static int expanded_count = 0;
+
+int process_toggle_threads(int pid) {
+    for (int i = 0; i < expanded_count; i++) {
+        if (expanded_pids[i] == pid) {
+            expanded_pids[i] = expanded_pids[--expanded_count];
+            return 0; // replié
+        }
+    }
+    if (expanded_count >= MAX_EXPANDED) return -1;
+    expanded_pids[expanded_count++] = pid;
+    return 1; // déplié
+}
+
+static int is_expanded(int pid) {
+    for (int i = 0; i < expanded_count; i++) {
+        if (expanded_pids[i] == pid) return 1;
+    }
+    return 0;
+}
+
+// Lit les threads /proc/<pid>/task/<tid>/stat d'un processus dans rows[]
+// Retourne le nombre de threads lus
+static int collect_threads(const ProcessInfo *proc, ProcessInfo rows[], int max_rows,
+                           PidTable *thread_table,
+                           unsigned long long prev_total_cpu,
+                           unsigned long long current_total_cpu,
+                           int flags, double now) {
+    char path[512], buf[1024];
+    snprintf(path, sizeof(path), "%s/%d/task", proc_root, proc->pid);
+    DIR *dir = opendir(path);
+    PROF_OPEN();
+    if (!dir) return 0;
+
+    int n = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && n < max_rows) {
+        if (!is_pid(entry->d_name)) continue;
+        PidState *st = pidtable_get(thread_table, atoi(entry->d_name));
+        if (!st) continue;
+
+        ProcessInfo *t = &rows[n];
+        snprintf(path, sizeof(path), "%s/%d/task/%s/stat", proc_root, proc->pid, entry->d_name);
+        if (pidtable_read(&st->stat_fd, path, buf, sizeof(buf)) <= 0 || !parse_stat_cached(buf, t, thread_table, st)) continue;
+
+        // Les threads partagent la mémoire, l'utilisateur et la ligne de commande du
+        // processus. Le masque de coeurs aussi, sauf si USER est différé : la
+        // lecture au rendu de /proc/<tid>/status donne alors celui du thread
+        t->user_id = proc->user_id;
+        t->cmd_id = proc->cmd_id;
+        t->affinity_id = proc->affinity_id;
+        t->virt = proc->virt;
+        t->res = proc->res;
+        t->shr = proc->shr;
+        t->mem_percent = proc->mem_percent;
+        t->tgid = proc->pid;
+        t->is_thread = 1;
+        t->io_valid = 0;
+        t->cgroup_id = proc->cgroup_id;
+        t->alert = 0; // les règles portent sur les processus
+        t->missing = proc->missing; // lus au rendu comme ceux du processus (/proc/<tid> existe)
+        t->smaps_valid = proc->smaps_valid;
+        t->pss = proc->pss;
+        t->uss = proc->uss;
+        t->swap = proc->swap;
+        t->cpu_percent = (st->samples > 0)
+            ? calculate_cpu_percent(t->time, st->prev_time, current_total_cpu, prev_total_cpu)
+            : 0.0;
+        st->prev_time = t->time;
+        st->samples++;
+        if (flags & COLLECT_SCHED) { // chaque thread a sa propre file d'attente
+            snprintf(path, sizeof(path), "%s/%d/task/%s/schedstat", proc_root, proc->pid, entry->d_name);
+            read_sched(path, t, st, now);
+        } else {
+            skip_sched(t, st);
         }
+        n++;
     }
     closedir(dir);
-    return count;
-}
\ No newline at end of file
+    return n;
+}
+
+// process_expand_threads
+// Construit la liste affichée : chaque processus suivi de ses threads (triés par CPU%)
+// s'il dépasse THREAD_CPU_THRESHOLD ou s'il a été déplié explicitement.
+int process_expand_threads(ProcessInfo processes[], int count,
+                           ProcessInfo rows[], int max_rows,
+                           PidTable *thread_table,
+                           unsigned long long prev_total_cpu,
+                           unsigned long long current_total_cpu,
+                           int flags) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = ts.tv_sec + ts.tv_nsec / 1e9;
+    int n = 0;
+    pidtable_begin(thread_table); // les threads des processus repliés seront oubliés
+
+    for (int i = 0; i < count && n < max_rows; i++) {
+        rows[n++] = processes[i];
+        const ProcessInfo *p = &processes[i];
+        if (p->num_threads <= 1) continue;
+        if (p->cpu_percent < THREAD_CPU_THRESHOLD && !is_expanded(p->pid)) continue;
+
+        int t = collect_threads(p, &rows[n], max_rows - n, thread_table,
+                                prev_total_cpu, current_total_cpu, flags, now);
+        qsort(&rows[n], t, sizeof(ProcessInfo), compare_cpu);
+        n += t;
+    }
+    pidtable_sweep(thread_table);
+    return n;
+}
@@ -3,21 +3,55 @@
 
 #include <sys/types.h>
 #include <unistd.h> // Pour sysconf
+#include "pidtable.h"
+#include "strpool.h"
 
 #define MAX_PID 65536
 #define MAX_PROCESSES 1024
+#define MAX_DISPLAY_ROWS 4096       // processus + threads dépliés
+#define MAX_EXPANDED 64             // processus dépliés explicitement
+#define THREAD_CPU_THRESHOLD 5.0    // CPU% au-delà duquel les threads sont dépliés
+#define PROC_ROOT_MAX 128           // longueur max de la racine du procfs
+#define MAX_WATCH 64                // pids et fichiers de pid suivis (--pid, --pidfile)
+#define WATCH_PATH_MAX 256
 
 // Définition des modes de tri
 typedef enum {
     SORT_CPU, // 0 par défaut
-    SORT_MEM  // 1
+    SORT_MEM, // 1
+    SORT_IO_READ,  // débit de lecture disque
+    SORT_IO_WRITE, // débit d'écriture disque
+    SORT_PSS,      // mémoire proportionnelle (valeurs smaps_rollup en cache)
+    SORT_DELAY     // attente en file d'exécution (schedstat)
 } SortMode;
 
+// Options de collecte (paramètre flags de process_collect_all)
+#define COLLECT_IO 0x1      // lire /proc/<pid>/io (colonnes RD/s WR/s visibles ou tri I/O)
+#define COLLECT_CGROUP 0x2  // résoudre le cgroup de chaque pid (vue conteneurs)
+// Champs lus pour tous les pids pendant le balayage. Sans ces bits, ils sont
+// différés : process_fill_rows() les lit pour les seules lignes affichées.
+// Un filtre qui teste ces champs force leur lecture.
+#define COLLECT_MEM 0x4     // /proc/<pid>/statm : VIRT RES SHR MEM% (tri MEM, arbre, cgroups)
+#define COLLECT_USER 0x8    // /proc/<pid>/status : USER
+#define COLLECT_FIELDS (COLLECT_MEM | COLLECT_USER)
+#define COLLECT_SMAPS 0x10  // recopier PSS/USS/SWAP du cache (aucune lecture, voir process_smaps_update)
+#define COLLECT_SCHED 0x20  // lire /proc/<pid>/schedstat avec stat (colonne DLY% visible ou tri)
+
+#define SMAPS_INTERVAL 10.0         // âge max des valeurs smaps_rollup en cache (s)
+#define SMAPS_PAGE_BUDGET_MS 20.0   // lecture des lignes affichées jamais lues, avant le rendu
+#define SMAPS_IDLE_BUDGET_MS 1.0    // tranche de fond, entre deux trames (toutes les 10 ms)
+
 // Définition de la structure ProcessInfo
 typedef struct {
-    int pid;
-    char user[64];
-    char name[256];
+    int pid;                  // tid pour une ligne de thread
+    int tgid;                 // processus propriétaire (== pid pour un processus)
+    int is_thread;            // 1 : ligne de thread (mode thread)
+    int num_threads;
+    int ppid;
+    // Chaînes internées (strpool.h), partagées entre instantanés et sources
+    int user_id;              // nom d'utilisateur (0 : pas encore lu)
+    int name_id;              // comm : nom court du noyau (15 caractères) ou de ps
+    int cmd_id;               // ligne de commande complète (0 : vide, thread noyau)
     char state;
     long priority;
     long nice;
@@ -27,27 +61,111 @@ typedef struct {
     double mem_percent;
     unsigned long time;       // utime+stime
     double cpu_percent;
+
+    // Placement : dernier coeur (39e champ de stat, psr de ps), son noeud NUMA
+    // et les coeurs autorisés (Cpus_allowed_list de status, lu avec USER)
+    int last_cpu;             // -1 : inconnu
+    int numa_node;            // -1 : inconnu (hôte distant)
+    int affinity_id;          // liste de coeurs internée (0 : pas encore lue)
+
+    // I/O disque (/proc/<pid>/io), en octets par seconde
+    int io_valid;                    // 0 : non collecté ou accès refusé
+    double io_read_rate;
+    double io_write_rate;
+
+    // /proc/<pid>/schedstat (COLLECT_SCHED) : part du temps écoulé passée
+    // prête à s'exécuter mais en attente d'un CPU (thread principal du processus)
+    int sched_valid;                 // 0 : non collecté ou première mesure
+    double sched_delay;              // en %, 100 = en attente pendant tout l'intervalle
+
+    int alert;                       // règles d'alerte vérifiées (ALERT_PENDING, ALERT_FIRING de alert.h)
+
+    int cgroup_id;                   // chemin de cgroup interné (0 : inconnu)
+    int missing;                     // champs différés pas encore lus (COLLECT_MEM, COLLECT_USER)
+
+    // /proc/<pid>/smaps_rollup (COLLECT_SMAPS), en octets
+    int smaps_valid;                 // 0 : pas encore lu ou illisible
+    unsigned long pss;
+    unsigned long uss;
+    unsigned long swap;
+
+    // Vue arborescente (remplis par proctree_build)
+    int depth;                       // profondeur dans l'arbre (0 : racine)
+    unsigned long long tree_mask;    // bit l : l'ancêtre de niveau l+1 a encore des frères
+    int children;                    // nombre d'enfants directs affichés
+    double tree_cpu;                 // CPU% cumulé du sous-arbre
+    double tree_mem;                 // MEM% cumulé du sous-arbre
 } ProcessInfo;
 
+#define CMDLINE_MAX 4096            // octets lus dans /proc/<pid>/cmdline
+
+// Chaînes d'une ligne (valables jusqu'au prochain strpool_collect())
+static inline const char *process_user(const ProcessInfo *p) { return strpool_get(p->user_id); }
+static inline const char *process_name(const ProcessInfo *p) { return strpool_get(p->name_id); }
+static inline const char *process_cmdline(const ProcessInfo *p) { return strpool_get(p->cmd_id); }
+static inline const char *process_affinity(const ProcessInfo *p) { return strpool_get(p->affinity_id); }
+
 int is_pid(const char *name);
+int parse_stat(const char *buf, ProcessInfo *info);
 int read_stat(const char *pid_str, ProcessInfo *info);
 int read_statm(const char *pid_str, ProcessInfo *info, unsigned long mem_total);
 int read_user(const char *pid_str, ProcessInfo *info);
 
 
+// Racine du procfs ("/proc" par défaut), à fixer avant la première collecte
+void process_set_proc_root(const char *root);
+const char *process_proc_root(void);
+
+// Mode surveillance : la collecte ne lit que ces pids (et leurs descendants
+// si demandé), sans balayer /proc. Retournent 0, ou -1 si la liste est pleine.
+int process_watch_pid(int pid);
+int process_watch_pidfile(const char *path);   // relu à chaque collecte
+void process_watch_descendants(int enable);    // via /proc/<pid>/task/<tid>/children
+int process_watch_active(void);
+
+// Lectures de stat/statm groupées par io_uring (désactivées par défaut).
+// Retourne 1 si actif, 0 si io_uring est indisponible : la collecte reste alors sur pread.
+int process_set_io_uring(int enable);
+
 // Fonctions publiques de collecte
 unsigned long long process_get_total_cpu_time(void);
 unsigned long process_get_mem_total(void);
-void process_initial_scan(unsigned long prev_proc_times[]);
+void process_initial_scan(PidTable *table);
 
 // Fonction principale de collecte/calcul
 int process_collect_all(ProcessInfo processes[], int max_count,
                         unsigned long long prev_total_cpu,
-                        unsigned long prev_proc_times[],
-                        unsigned long long current_total_cpu);
+                        PidTable *table,
+                        unsigned long long current_total_cpu,
+                        int flags);
+
+// Lit les champs différés (missing) des lignes données, typiquement la page affichée
+void process_fill_rows(ProcessInfo rows[], int count);
+
+// Lit smaps_rollup pour les lignes données (les threads sont ignorés) et met
+// à jour le cache du pid et la ligne. only_missing : seulement les pids jamais
+// lus, sinon aussi ceux dont la valeur a plus de SMAPS_INTERVAL secondes.
+// S'arrête après budget_ms ; l'appel suivant reprend où celui-ci s'est arrêté.
+// Retourne le nombre de fichiers lus.
+int process_smaps_update(PidTable *table, ProcessInfo rows[], int count,
+                         int only_missing, double budget_ms);
+
+// Mode thread : insère les threads sous chaque processus déplié
+// (flags : seul COLLECT_SCHED est pris en compte, schedstat de chaque thread)
+int process_expand_threads(ProcessInfo processes[], int count,
+                           ProcessInfo rows[], int max_rows,
+                           PidTable *thread_table,
+                           unsigned long long prev_total_cpu,
+                           unsigned long long current_total_cpu,
+                           int flags);
+// Déplie/replie les threads d'un pid. Retourne 1 si déplié, 0 si replié, -1 si liste pleine
+int process_toggle_threads(int pid);
 
 // Fonction de tri
 void process_sort(ProcessInfo processes[], int count, SortMode mode);
+// Tri partiel : seuls les k premiers sont triés, le reste est dans le désordre
+// (k <= 0 ou k >= count : tri complet)
+void process_sort_top(ProcessInfo processes[], int count, SortMode mode, int k);
 
 
 #endif
\ No newline at end of file
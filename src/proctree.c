@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include "proctree.h"
+
+// Contexte d'un parcours (évite de passer 6 paramètres à chaque appel récursif)
+typedef struct {
+    ProcessInfo *processes;
+    ProcessInfo *rows;
+    int max_rows;
+    int n;                 // lignes écrites
+    PidTable *table;
+    int *scratch;          // pile des indices d'enfants, un segment par niveau
+    int top;
+} TreeWalk;
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Position de l'entrée dans le tableau trié, ou -1 si elle n'y figure pas
+static int row_of(TreeWalk *w, const PidState *st) {
+    return (st && st->row_epoch == w->table->epoch) ? st->row : -1;
+}
+
+// Écrit le processus i puis ses descendants (préfixe), et cumule les valeurs
+// du sous-arbre au retour (postfixe). Retourne l'indice de la ligne écrite, ou -1.
+static int emit(TreeWalk *w, int i, int depth, unsigned long long mask) {
+    if (w->n >= w->max_rows) return -1;
+
+    int idx = w->n++;
+    ProcessInfo *row = &w->rows[idx];
+    *row = w->processes[i];
+    row->depth = depth;
+    row->tree_mask = mask;
+    row->children = 0;
+    row->tree_cpu = row->cpu_percent;
+    row->tree_mem = row->mem_percent;
+
+    // Enfants présents dans ce rafraîchissement, via l'index incrémental.
+    // Le tableau étant déjà trié, l'ordre des indices est l'ordre d'affichage.
+    PidState *st = pidtable_find(w->table, row->pid);
+    int base = w->top;
+    for (int c = st ? st->first_child : 0; c; ) {
+        PidState *child = pidtable_find(w->table, c);
+        if (!child) break;
+        int r = row_of(w, child);
+        if (r >= 0 && r != i) w->scratch[w->top++] = r;
+        c = child->next_sibling;
+    }
+    int k = w->top - base;
+    qsort(&w->scratch[base], k, sizeof(int), compare_int);
+
+    for (int j = 0; j < k; j++) {
+        unsigned long long child_mask = mask;
+        if (j < k - 1 && depth < TREE_MAX_MASK_DEPTH) child_mask |= 1ULL << depth;
+        int child_idx = emit(w, w->scratch[base + j], depth + 1, child_mask);
+        if (child_idx < 0) continue;
+        // w->rows[idx] : row peut avoir été écrit par un appel plus profond, pas déplacé
+        w->rows[idx].children++;
+        w->rows[idx].tree_cpu += w->rows[child_idx].tree_cpu;
+        w->rows[idx].tree_mem += w->rows[child_idx].tree_mem;
+    }
+    w->top = base;
+    return idx;
+}
+
+int proctree_build(ProcessInfo processes[], int count,
+                   ProcessInfo rows[], int max_rows,
+                   PidTable *table) {
+    static int *scratch = NULL;
+    static int scratch_cap = 0;
+    if (count > scratch_cap) {
+        int *tmp = realloc(scratch, sizeof(int) * count);
+        if (!tmp) return 0;
+        scratch = tmp;
+        scratch_cap = count;
+    }
+
+    // Position de chaque pid dans le tableau trié
+    for (int i = 0; i < count; i++) {
+        PidState *st = pidtable_find(table, processes[i].pid);
+        if (st) {
+            st->row = i;
+            st->row_epoch = table->epoch;
+        }
+    }
+
+    TreeWalk w = { processes, rows, max_rows, 0, table, scratch, 0 };
+
+    // Racines : processus dont le parent n'est pas affiché (init, kthreadd, orphelins...)
+    for (int i = 0; i < count; i++) {
+        PidState *parent = pidtable_find(table, processes[i].ppid);
+        if (row_of(&w, parent) < 0 || processes[i].ppid == processes[i].pid) {
+            emit(&w, i, 0, 0);
+        }
+    }
+    return w.n;
+}
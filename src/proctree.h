@@ -0,0 +1,17 @@
+#ifndef PROCTREE_H
+#define PROCTREE_H
+
+#include "process.h"
+
+#define TREE_MAX_MASK_DEPTH 64 // profondeur au-delà de laquelle les traits verticaux sont omis
+
+// proctree_build
+// Construit la vue arborescente à partir du tableau trié processes[] et de
+// l'index parent -> enfants tenu par la table : chaque processus est suivi de
+// ses enfants (dans l'ordre du tri), et les CPU%/MEM% des sous-arbres sont
+// cumulés en un seul parcours postfixe. Retourne le nombre de lignes écrites.
+int proctree_build(ProcessInfo processes[], int count,
+                   ProcessInfo rows[], int max_rows,
+                   PidTable *table);
+
+#endif
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "profile.h"
+
+ProfCounters prof_counters;
+
+const char *prof_phase_names[PROF_NPHASES] = {
+    "sysstats", "collect", " users", "sort", "view", "render", "ssh-exec", "ssh-read", "ssh-parse"
+};
+
+static double phase_start[PROF_NPHASES];
+static ProfReport current;
+static ProfReport last;
+static ProfCounters frame_counters;   // compteurs au début de la trame
+static double frame_start;
+static double prev_frame_end = 0;     // pour le CPU% de l'outil
+static double prev_cpu_ms = 0;
+
+double prof_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static double self_cpu_ms(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3
+         + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+void prof_start(ProfPhase phase) {
+    phase_start[phase] = prof_now_ms();
+}
+
+void prof_stop(ProfPhase phase) {
+    current.phase_ms[phase] += prof_now_ms() - phase_start[phase];
+}
+
+void prof_frame_begin(const char *source) {
+    memset(&current, 0, sizeof(current));
+    snprintf(current.source, sizeof(current.source), "%s", source);
+    frame_counters = prof_counters;
+    frame_start = prof_now_ms();
+}
+
+void prof_frame_end(void) {
+    double end = prof_now_ms();
+    current.frame_ms = end - frame_start;
+    current.counters.files_opened = prof_counters.files_opened - frame_counters.files_opened;
+    current.counters.bytes_read = prof_counters.bytes_read - frame_counters.bytes_read;
+    current.counters.syscalls = prof_counters.syscalls - frame_counters.syscalls;
+
+    // CPU de l'outil sur tout l'intervalle (boucle d'attente comprise)
+    double cpu = self_cpu_ms();
+    if (prev_frame_end > 0 && end > prev_frame_end) {
+        current.self_cpu_percent = 100.0 * (cpu - prev_cpu_ms) / (end - prev_frame_end);
+    }
+    prev_frame_end = end;
+    prev_cpu_ms = cpu;
+    last = current;
+}
+
+const ProfReport *prof_last_frame(void) {
+    return &last;
+}
@@ -0,0 +1,52 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// Auto-profilage : temps par phase (horloge monotone) et compteurs d'appels
+// système, pour voir le coût de l'outil lui-même. Toujours actif : quelques
+// clock_gettime (vDSO) par rafraîchissement et des incréments d'entiers.
+
+typedef enum {
+    PROF_SYSSTATS,   // /proc/stat, meminfo, loadavg
+    PROF_COLLECT,    // balayage de /proc (process_collect_all)
+    PROF_USERS,      // getpwuid, compris dans collect
+    PROF_SORT,       // process_sort
+    PROF_VIEW,       // arbre, threads, agrégation cgroup
+    PROF_RENDER,     // formatage et écriture du terminal
+    PROF_NET_EXEC,   // ouverture du canal ssh et lancement de ps
+    PROF_NET_READ,   // lecture de la sortie distante
+    PROF_NET_PARSE,  // analyse de la sortie distante
+    PROF_NPHASES
+} ProfPhase;
+
+typedef struct {
+    unsigned long files_opened;
+    unsigned long bytes_read;
+    unsigned long syscalls;   // open/read/pread/close/getdents comptés par l'outil
+} ProfCounters;
+
+// Bilan d'une trame (un rafraîchissement)
+typedef struct {
+    double phase_ms[PROF_NPHASES];
+    ProfCounters counters;    // deltas sur la trame
+    double frame_ms;          // durée totale de la trame
+    double self_cpu_percent;  // CPU consommé par l'outil entre deux trames / temps écoulé
+    char source[64];          // machine affichée ("local" ou nom d'hôte)
+} ProfReport;
+
+extern ProfCounters prof_counters;
+
+#define PROF_OPEN()     (prof_counters.files_opened++, prof_counters.syscalls++)
+#define PROF_READ(n)    (prof_counters.bytes_read += (unsigned long)(n), prof_counters.syscalls++)
+#define PROF_SYSCALL()  (prof_counters.syscalls++)
+
+double prof_now_ms(void);
+void prof_start(ProfPhase phase);
+void prof_stop(ProfPhase phase);
+
+void prof_frame_begin(const char *source);
+void prof_frame_end(void);
+const ProfReport *prof_last_frame(void);
+
+extern const char *prof_phase_names[PROF_NPHASES];
+
+#endif
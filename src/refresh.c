@@ -0,0 +1,102 @@
+#include <time.h>
+#include "refresh.h"
+
+static double cpu_budget = REFRESH_DEFAULT_CPU_BUDGET / 100.0; // fraction d'un coeur
+static double net_budget = REFRESH_DEFAULT_NET_BUDGET * 1024.0; // octets/s
+static int sources = 1;
+
+#define SMOOTHING 0.5      // poids de la nouvelle mesure dans les moyennes lissées
+#define CHURN_BUSY 0.25    // au-delà : on accélère
+#define CHURN_QUIET 0.02   // en deçà : on ralentit
+
+double refresh_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double refresh_cpu_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void refresh_init(RefreshState *st) {
+    st->interval = REFRESH_BASE_INTERVAL;
+    st->last_run = 0;
+    st->cost = 0;
+    st->bytes = 0;
+    st->churn = 0;
+    st->prev_count = -1;
+    st->fixed = 0;
+}
+
+void refresh_set_fixed(RefreshState *st, double interval) {
+    st->fixed = interval;
+    st->interval = interval;
+}
+
+int refresh_due(const RefreshState *st, double now) {
+    return st->last_run == 0 || now - st->last_run >= st->interval;
+}
+
+void refresh_set_budget(double cpu_percent, double kbytes_per_sec) {
+    if (cpu_percent > 0) cpu_budget = cpu_percent / 100.0;
+    if (kbytes_per_sec > 0) net_budget = kbytes_per_sec * 1024.0;
+}
+
+void refresh_set_sources(int count) {
+    sources = (count > 0) ? count : 1;
+}
+
+void refresh_record(RefreshState *st, double now, double cost, unsigned long bytes,
+                    double activity, int count, int viewed) {
+    if (st->fixed > 0) {
+        // échéance suivante sur la grille, sauf après un retard de plus d'une période
+        if (st->last_run == 0 || now - st->last_run >= 2 * st->fixed) st->last_run = now;
+        else st->last_run += st->fixed;
+        st->prev_count = count;
+        return;
+    }
+
+    // Variation du nombre de processus : 10% de processus apparus/disparus = très actif
+    double turnover = 0;
+    if (st->prev_count > 0) {
+        int delta = count - st->prev_count;
+        turnover = 10.0 * (delta < 0 ? -delta : delta) / st->prev_count;
+    }
+    double change = (activity > turnover) ? activity : turnover;
+    if (change > 1) change = 1;
+
+    if (st->last_run == 0) { // première mesure : pas d'historique à lisser
+        st->cost = cost;
+        st->bytes = bytes;
+        st->churn = change;
+    } else {
+        st->cost += SMOOTHING * (cost - st->cost);
+        st->bytes += SMOOTHING * ((double)bytes - st->bytes);
+        st->churn += SMOOTHING * (change - st->churn);
+    }
+    st->prev_count = count;
+    st->last_run = now;
+
+    double max_interval = viewed ? REFRESH_VIEWED_MAX : REFRESH_MAX_INTERVAL;
+    double interval = st->interval;
+    if (st->churn >= CHURN_BUSY) {
+        if (interval > REFRESH_BASE_INTERVAL) interval = REFRESH_BASE_INTERVAL;
+        interval *= 0.5;
+    } else if (st->churn < CHURN_QUIET) {
+        interval *= 1.5;
+    } else {
+        interval = REFRESH_BASE_INTERVAL;
+    }
+    if (interval < REFRESH_MIN_INTERVAL) interval = REFRESH_MIN_INTERVAL;
+    if (interval > max_interval) interval = max_interval;
+
+    // Plancher du budget : chaque source a droit à une part égale
+    double floor_cpu = st->cost / (cpu_budget / sources);
+    double floor_net = st->bytes / (net_budget / sources);
+    if (interval < floor_cpu) interval = floor_cpu;
+    if (interval < floor_net) interval = floor_net;
+    st->interval = interval;
+}
@@ -0,0 +1,49 @@
+#ifndef REFRESH_H
+#define REFRESH_H
+
+// Ordonnancement adaptatif des rafraîchissements, un état par source
+// (machine locale ou hôte distant). L'intervalle part de 2 s, raccourcit quand
+// l'activité CPU ou le nombre de processus bouge beaucoup, s'allonge quand la
+// source ne change presque pas, et ne descend jamais sous le plancher imposé
+// par le budget global (temps CPU et débit réseau du moniteur lui-même).
+
+#define REFRESH_BASE_INTERVAL 2.0    // intervalle historique (s)
+#define REFRESH_MIN_INTERVAL 0.5
+#define REFRESH_VIEWED_MAX 4.0       // source affichée : jamais plus lente
+#define REFRESH_MAX_INTERVAL 30.0    // source en arrière-plan
+#define REFRESH_WATCH_INTERVAL 0.1   // mode surveillance (--pid, --pidfile)
+#define REFRESH_DEFAULT_CPU_BUDGET 5.0     // % d'un coeur
+#define REFRESH_DEFAULT_NET_BUDGET 256.0   // Ko/s
+
+typedef struct {
+    double interval;     // intervalle courant (s)
+    double last_run;     // horloge monotone de la dernière collecte, 0 : jamais
+    double cost;         // temps CPU d'une collecte (s), lissé
+    double bytes;        // octets reçus par collecte, lissé
+    double churn;        // activité lissée, de 0 (figé) à 1 (très actif)
+    int prev_count;      // nombre de processus à la collecte précédente
+    double fixed;        // intervalle imposé (mode surveillance), 0 : adaptatif
+} RefreshState;
+
+void refresh_init(RefreshState *st);
+// Intervalle fixe, hors budget : les collectes suivent une grille régulière
+// sur l'horloge monotone, sans dérive d'une trame à l'autre
+void refresh_set_fixed(RefreshState *st, double interval);
+
+// 1 si la source doit être collectée à l'instant now
+int refresh_due(const RefreshState *st, double now);
+
+// Bilan d'une collecte : cost en secondes CPU, bytes reçus (0 en local),
+// activity = CPU utilisé par les processus de la source (0..1),
+// viewed = source affichée. Recalcule l'intervalle.
+void refresh_record(RefreshState *st, double now, double cost, unsigned long bytes,
+                    double activity, int count, int viewed);
+
+// Budget global, partagé entre les sources collectées régulièrement
+void refresh_set_budget(double cpu_percent, double kbytes_per_sec);
+void refresh_set_sources(int count);
+
+double refresh_now(void);       // horloge monotone (s)
+double refresh_cpu_time(void);  // temps CPU consommé par le moniteur (s)
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef SHM_LAYOUT_H
+#define SHM_LAYOUT_H
+
+// Format de l'instantané publié en mémoire partagée (--export-shm)
+//
+// Région POSIX (shm_open, nom par défaut "/my_htop", soit /dev/shm/my_htop),
+// en lecture seule pour les consommateurs :
+//
+//   [ ShmSnapshotHeader : 128 octets ][ capacity x ShmProcessRecord : 192 octets ]
+//
+// Les records sont triés par CPU% décroissant (liste "top") ; seuls les count
+// premiers sont valides. Tous les champs sont de taille fixe, en ordre
+// d'octets natif, sans dépendance à ProcessInfo.
+//
+// Cohérence (seqlock) : l'écrivain rend seq impair, écrit, puis le rend pair.
+// Un lecteur copie ce dont il a besoin entre deux lectures de seq et
+// recommence si seq était impair ou a changé (voir shm_snapshot_read()).
+// Aucun appel système ni analyse de texte côté lecteur.
+//
+// Versions : toute modification incompatible incrémente SHM_SNAPSHOT_VERSION.
+// Les ajouts se font dans les zones reserved, header_size et record_size
+// permettant à un lecteur plus ancien de sauter ce qu'il ne connaît pas.
+
+#include <stdint.h>
+#include <string.h>
+
+#define SHM_SNAPSHOT_MAGIC 0x4e53484du    // "MHSN"
+#define SHM_SNAPSHOT_VERSION 1
+#define SHM_SNAPSHOT_DEFAULT_NAME "/my_htop"
+#define SHM_SNAPSHOT_CAPACITY 1024        // records réservés dans la région
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;        // sizeof(ShmSnapshotHeader)
+    uint32_t record_size;        // sizeof(ShmProcessRecord)
+    uint32_t capacity;           // nombre de records de la région
+    uint64_t seq;                // seqlock : impair = écriture en cours
+    uint64_t timestamp_ns;       // CLOCK_REALTIME de la collecte
+    uint32_t count;              // records valides
+    uint32_t cpu_count;
+    double total_cpu_percent;    // utilisation globale de la machine
+    uint64_t mem_total;          // octets
+    uint64_t mem_available;      // octets
+    double load[3];
+    uint32_t writer_pid;         // processus qui publie
+    uint8_t reserved[36];
+} ShmSnapshotHeader;
+
+typedef struct {
+    int32_t pid;
+    int32_t ppid;
+    int32_t num_threads;
+    int32_t priority;
+    int32_t nice;
+    char state;                  // R, S, D, Z...
+    uint8_t reserved0[3];
+    uint64_t virt;               // octets
+    uint64_t res;                // octets
+    uint64_t shr;                // octets
+    uint64_t cpu_ticks;          // utime + stime
+    double cpu_percent;          // 100% = toute la machine
+    double mem_percent;
+    char user[32];
+    char name[64];
+    uint8_t reserved[24];
+} ShmProcessRecord;
+
+_Static_assert(sizeof(ShmSnapshotHeader) == 128, "ShmSnapshotHeader : 128 octets");
+_Static_assert(sizeof(ShmProcessRecord) == 192, "ShmProcessRecord : 192 octets");
+
+static inline const ShmProcessRecord *shm_snapshot_records(const ShmSnapshotHeader *h) {
+    return (const ShmProcessRecord *)((const char *)h + h->header_size);
+}
+
+// Copie cohérente de l'en-tête et des max premiers records. Retourne le
+// nombre de records copiés, ou -1 si la région n'est pas au bon format.
+// (Lecteur de référence, à recopier tel quel dans un consommateur.)
+static inline int shm_snapshot_read(const ShmSnapshotHeader *h, ShmSnapshotHeader *hdr_out,
+                                    ShmProcessRecord *out, int max) {
+    if (h->magic != SHM_SNAPSHOT_MAGIC || h->version != SHM_SNAPSHOT_VERSION ||
+        h->record_size != sizeof(ShmProcessRecord)) return -1;
+    for (;;) {
+        uint64_t s1 = __atomic_load_n(&h->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue; // écriture en cours
+        memcpy(hdr_out, h, sizeof(*hdr_out));
+        int n = (int)hdr_out->count;
+        if (n > (int)hdr_out->capacity) n = (int)hdr_out->capacity;
+        if (n > max) n = max;
+        memcpy(out, shm_snapshot_records(h), sizeof(ShmProcessRecord) * n);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&h->seq, __ATOMIC_RELAXED) == s1) return n;
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "shmexport.h"
+
+static ShmSnapshotHeader *region = NULL;
+static size_t region_size = 0;
+static char region_name[64];
+
+// Records préparés hors section critique : l'écrivain ne garde seq impair
+// que le temps d'un memcpy
+static ShmProcessRecord staging[SHM_SNAPSHOT_CAPACITY];
+// Processus candidats (threads exclus), triés par CPU% avant la copie : la
+// région garde le haut de la liste, quel que soit l'ordre de collecte
+static const ProcessInfo **candidates = NULL;
+static int candidates_cap = 0;
+
+int shmexport_open(const char *name) {
+    if (region) shmexport_close();
+    if (name[0] != '/' || strlen(name) >= sizeof(region_name) || strchr(name + 1, '/')) {
+        fprintf(stderr, "Nom de mémoire partagée invalide: %s (attendu: /nom)\n", name);
+        return -1;
+    }
+    region_size = sizeof(ShmSnapshotHeader) + sizeof(ShmProcessRecord) * SHM_SNAPSHOT_CAPACITY;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) { perror("shm_open"); return -1; }
+    if (ftruncate(fd, region_size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // le mapping reste valide
+    if (p == MAP_FAILED) { perror("mmap"); return -1; }
+
+    region = p;
+    strcpy(region_name, name);
+    memset(region, 0, sizeof(*region));
+    region->header_size = sizeof(ShmSnapshotHeader);
+    region->record_size = sizeof(ShmProcessRecord);
+    region->capacity = SHM_SNAPSHOT_CAPACITY;
+    region->version = SHM_SNAPSHOT_VERSION;
+    region->writer_pid = (uint32_t)getpid();
+    // magic en dernier : un lecteur ne voit jamais un en-tête à moitié initialisé
+    __atomic_store_n(&region->magic, SHM_SNAPSHOT_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int compare_candidate_cpu(const void *a, const void *b) {
+    const ProcessInfo *pa = *(const ProcessInfo *const *)a, *pb = *(const ProcessInfo *const *)b;
+    if (pa->cpu_percent < pb->cpu_percent) return 1;
+    if (pa->cpu_percent > pb->cpu_percent) return -1;
+    return 0;
+}
+
+static void copy_text(char *dst, size_t size, const char *src) {
+    size_t n = strnlen(src, size - 1);
+    memcpy(dst, src, n);
+    memset(dst + n, 0, size - n);
+}
+
+void shmexport_publish(const ProcessInfo processes[], int count, const SystemStats *stats) {
+    if (!region) return;
+    if (count > candidates_cap) {
+        const ProcessInfo **c = realloc(candidates, sizeof(*c) * count);
+        if (!c) return;
+        candidates = c;
+        candidates_cap = count;
+    }
+    int ncand = 0;
+    for (int i = 0; i < count; i++) {
+        // lignes du mode thread : pas dans la liste des processus
+        if (!processes[i].is_thread) candidates[ncand++] = &processes[i];
+    }
+    qsort(candidates, ncand, sizeof(*candidates), compare_candidate_cpu);
+
+    int n = (ncand < SHM_SNAPSHOT_CAPACITY) ? ncand : SHM_SNAPSHOT_CAPACITY;
+    for (int i = 0; i < n; i++) {
+        const ProcessInfo *p = candidates[i];
+        ShmProcessRecord *r = &staging[i];
+        memset(r, 0, sizeof(*r));
+        r->pid = p->pid;
+        r->ppid = p->ppid;
+        r->num_threads = p->num_threads;
+        r->priority = (int32_t)p->priority;
+        r->nice = (int32_t)p->nice;
+        r->state = p->state;
+        r->virt = p->virt;
+        r->res = p->res;
+        r->shr = p->shr;
+        r->cpu_ticks = p->time;
+        r->cpu_percent = p->cpu_percent;
+        r->mem_percent = p->mem_percent;
+        copy_text(r->user, sizeof(r->user), process_user(p));
+        copy_text(r->name, sizeof(r->name), process_name(p));
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    // seqlock : seq impair pendant l'écriture
+    uint64_t seq = region->seq;
+    __atomic_store_n(&region->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    region->timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    region->count = n;
+    if (stats) {
+        region->cpu_count = stats->cpu_count;
+        region->total_cpu_percent = stats->total_percent;
+        region->mem_total = stats->mem_total;
+        region->mem_available = stats->mem_available;
+        memcpy(region->load, stats->load, sizeof(region->load));
+    }
+    memcpy((char *)region + region->header_size, staging, sizeof(ShmProcessRecord) * n);
+
+    __atomic_store_n(&region->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void shmexport_close(void) {
+    if (!region) return;
+    munmap(region, region_size);
+    shm_unlink(region_name);
+    region = NULL;
+    free(candidates);
+    candidates = NULL;
+    candidates_cap = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef SHMEXPORT_H
+#define SHMEXPORT_H
+
+#include "process.h"
+#include "sysstats.h"
+#include "shm_layout.h"
+
+// Publication des instantanés locaux en mémoire partagée (format : shm_layout.h)
+
+// Crée (ou recrée) la région. Retourne 0 si ok, -1 sinon (message sur stderr).
+int shmexport_open(const char *name);
+
+// Publie un instantané (no-op si la région n'est pas ouverte).
+// Les processus sont recopiés triés par CPU%, processes[] n'est pas modifié.
+void shmexport_publish(const ProcessInfo processes[], int count, const SystemStats *stats);
+
+// Démappe et supprime la région
+void shmexport_close(void);
+
+#endif
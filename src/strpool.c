@@ -0,0 +1,229 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "strpool.h"
+
+#define STRPOOL_GEN_BITS 8          // identifiant : (entrée << 8) | génération
+#define STRPOOL_GEN_MASK ((1u << STRPOOL_GEN_BITS) - 1)
+#define STRPOOL_MAX_ENTRIES (1 << (31 - STRPOOL_GEN_BITS))
+
+typedef struct {
+    char *str;                // NULL : entrée libre
+    unsigned int len;
+    unsigned int hash;
+    unsigned int stamp;       // horloge du pool au dernier usage
+    unsigned int gen;         // incrémentée à chaque libération de l'entrée
+    int next_free;            // chaînage des entrées libres
+} PoolEntry;
+
+static PoolEntry *entries = NULL;     // l'entrée 0 est réservée (chaîne vide)
+static int entry_cap = 0;
+static int entry_top = 1;             // entrées déjà attribuées au moins une fois
+static int free_head = 0;             // 0 : aucune entrée libre
+static int live = 0;
+
+// Table de hachage chaîne -> entrée (adressage ouvert, au plus à moitié pleine)
+static int *index_tab = NULL;
+static int index_cap = 0;             // puissance de 2
+
+// Blocs de STRPOOL_CHUNK octets, remplis bout à bout
+static char **chunks = NULL;
+static int nchunks = 0;
+static int chunk_cap = 0;
+static size_t chunk_fill = 0;         // octets utilisés dans le dernier bloc
+
+static unsigned int pool_clock = 0;   // secondes (monotone), mise à jour par strpool_collect()
+static unsigned int last_sweep = 0;
+
+static unsigned int clock_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)ts.tv_sec + 1; // jamais 0 : 0 signifie "pas encore lue"
+}
+
+static unsigned int hash_bytes(const char *s, size_t len) {
+    unsigned int h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++) { h ^= (unsigned char)s[i]; h *= 16777619u; }
+    return h;
+}
+
+static PoolEntry *entry_of(int id) {
+    int slot = id >> STRPOOL_GEN_BITS;
+    if (id <= 0 || slot >= entry_top) return NULL;
+    PoolEntry *e = &entries[slot];
+    if (!e->str || (e->gen & STRPOOL_GEN_MASK) != ((unsigned int)id & STRPOOL_GEN_MASK)) return NULL;
+    return e;
+}
+
+// Place pour n octets dans le dernier bloc, nouveau bloc si besoin
+static char *arena_alloc(size_t n) {
+    if (nchunks == 0 || chunk_fill + n > STRPOOL_CHUNK) {
+        if (nchunks == chunk_cap) {
+            int new_cap = chunk_cap ? chunk_cap * 2 : 16;
+            char **p = realloc(chunks, new_cap * sizeof(char *));
+            if (!p) return NULL;
+            chunks = p;
+            chunk_cap = new_cap;
+        }
+        char *chunk = malloc(STRPOOL_CHUNK);
+        if (!chunk) return NULL;
+        chunks[nchunks++] = chunk;
+        chunk_fill = 0;
+    }
+    char *dst = chunks[nchunks - 1] + chunk_fill;
+    chunk_fill += n;
+    return dst;
+}
+
+// Reconstruit la table de hachage pour les entrées vivantes (capacité ajustée,
+// elle peut aussi rétrécir)
+static int index_rebuild(int min_live) {
+    int cap = 1024;
+    while (min_live * 2 > cap) cap *= 2;
+    int *tab = calloc(cap, sizeof(int));
+    if (!tab) return -1;
+    for (int slot = 1; slot < entry_top; slot++) {
+        if (!entries[slot].str) continue;
+        unsigned int i = entries[slot].hash & (cap - 1);
+        while (tab[i] != 0) i = (i + 1) & (cap - 1);
+        tab[i] = slot;
+    }
+    free(index_tab);
+    index_tab = tab;
+    index_cap = cap;
+    return 0;
+}
+
+int strpool_intern(const char *s, size_t len) {
+    if (len == 0) return 0;
+    if (len > STRPOOL_MAX_LEN) len = STRPOOL_MAX_LEN;
+    if (pool_clock == 0) pool_clock = last_sweep = clock_now();
+    if ((live + 1) * 2 > index_cap && index_rebuild(live + 1) != 0) return -1;
+
+    unsigned int h = hash_bytes(s, len);
+    unsigned int i = h & (index_cap - 1);
+    while (index_tab[i] != 0) {
+        PoolEntry *e = &entries[index_tab[i]];
+        if (e->hash == h && e->len == len && memcmp(e->str, s, len) == 0) {
+            e->stamp = pool_clock;
+            return (index_tab[i] << STRPOOL_GEN_BITS) | (int)(e->gen & STRPOOL_GEN_MASK);
+        }
+        i = (i + 1) & (index_cap - 1);
+    }
+
+    int slot = free_head;
+    if (slot == 0) {
+        if (entry_top >= STRPOOL_MAX_ENTRIES) return -1;
+        if (entry_top >= entry_cap) {
+            int new_cap = entry_cap ? entry_cap * 2 : 1024;
+            PoolEntry *p = realloc(entries, new_cap * sizeof(PoolEntry));
+            if (!p) return -1;
+            memset(p + entry_cap, 0, (new_cap - entry_cap) * sizeof(PoolEntry));
+            entries = p;
+            entry_cap = new_cap;
+        }
+        slot = entry_top;
+    }
+    char *dst = arena_alloc(len + 1);
+    if (!dst) return -1;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    if (slot == free_head) free_head = entries[slot].next_free;
+    else entry_top++;
+
+    PoolEntry *e = &entries[slot];
+    e->str = dst;
+    e->len = (unsigned int)len;
+    e->hash = h;
+    e->stamp = pool_clock;
+    e->next_free = 0;
+    index_tab[i] = slot;
+    live++;
+    return (slot << STRPOOL_GEN_BITS) | (int)(e->gen & STRPOOL_GEN_MASK);
+}
+
+const char *strpool_get(int id) {
+    PoolEntry *e = entry_of(id);
+    return e ? e->str : "";
+}
+
+size_t strpool_len(int id) {
+    PoolEntry *e = entry_of(id);
+    return e ? e->len : 0;
+}
+
+int strpool_valid(int id) {
+    return id == 0 || entry_of(id) != NULL;
+}
+
+void strpool_touch(int id) {
+    PoolEntry *e = entry_of(id);
+    if (e) e->stamp = pool_clock;
+}
+
+void strpool_collect(void) {
+    if (live == 0) return;
+    pool_clock = clock_now();
+    if (pool_clock - last_sweep < STRPOOL_TTL / 4) return;
+    last_sweep = pool_clock;
+
+    int dead = 0;
+    for (int slot = 1; slot < entry_top; slot++) {
+        if (entries[slot].str && pool_clock - entries[slot].stamp > STRPOOL_TTL) dead++;
+    }
+    if (dead == 0) return;
+
+    // Les survivantes sont recopiées dans des blocs neufs, alloués d'avance :
+    // un échec d'allocation laisse le pool intact
+    int need = 0;
+    size_t fill = STRPOOL_CHUNK;
+    for (int slot = 1; slot < entry_top; slot++) {
+        PoolEntry *e = &entries[slot];
+        if (!e->str || pool_clock - e->stamp > STRPOOL_TTL) continue;
+        if (fill + e->len + 1 > STRPOOL_CHUNK) { need++; fill = 0; }
+        fill += e->len + 1;
+    }
+    char **blocks = malloc((need ? need : 1) * sizeof(char *));
+    if (!blocks) return;
+    for (int i = 0; i < need; i++) {
+        if (!(blocks[i] = malloc(STRPOOL_CHUNK))) {
+            while (i-- > 0) free(blocks[i]);
+            free(blocks);
+            return;
+        }
+    }
+    int count = 0;
+    fill = STRPOOL_CHUNK;
+    for (int slot = 1; slot < entry_top; slot++) {
+        PoolEntry *e = &entries[slot];
+        if (!e->str) continue;
+        if (pool_clock - e->stamp > STRPOOL_TTL) {
+            e->str = NULL;
+            e->len = 0;
+            e->gen++; // les identifiants encore en circulation deviennent périmés
+            e->next_free = free_head;
+            free_head = slot;
+            live--;
+            continue;
+        }
+        if (fill + e->len + 1 > STRPOOL_CHUNK) { count++; fill = 0; }
+        char *dst = blocks[count - 1] + fill;
+        memcpy(dst, e->str, e->len + 1);
+        e->str = dst;
+        fill += e->len + 1;
+    }
+    for (int i = 0; i < nchunks; i++) free(chunks[i]);
+    free(chunks);
+    chunks = blocks;
+    nchunks = chunk_cap = need;
+    chunk_fill = need ? fill : 0;
+    index_rebuild(live);
+}
+
+int strpool_count(void) {
+    return live;
+}
+
+size_t strpool_bytes(void) {
+    return (size_t)nchunks * STRPOOL_CHUNK;
+}
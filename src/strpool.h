@@ -0,0 +1,43 @@
+#ifndef STRPOOL_H
+#define STRPOOL_H
+
+#include <stddef.h>
+
+// Pool de chaînes dédupliquées (utilisateurs, noms, lignes de commande),
+// partagé par toutes les sources et tous les instantanés : ProcessInfo ne
+// porte que des identifiants.
+//
+// Les chaînes sont rangées bout à bout dans des blocs de STRPOOL_CHUNK octets.
+// Une chaîne ni internée ni touchée depuis STRPOOL_TTL secondes est libérée
+// par strpool_collect(), qui recopie alors les survivantes dans des blocs
+// neufs : la mémoire suit les chaînes vivantes, pas le nombre de collectes.
+// L'identifiant porte un numéro de génération : un identifiant libéré (puis
+// réattribué) n'est plus valide et strpool_get() rend "" au lieu d'une autre chaîne.
+
+#define STRPOOL_CHUNK (64 * 1024)
+#define STRPOOL_MAX_LEN 4096        // chaînes plus longues tronquées
+#define STRPOOL_TTL 120             // s sans référence avant libération
+
+// Identifiant de la chaîne (0 : chaîne vide), créée si besoin.
+// -1 si plus de mémoire (traité comme "" partout).
+int strpool_intern(const char *s, size_t len);
+
+// Chaîne de l'identifiant, "" si 0 ou périmé. Le pointeur reste valable
+// jusqu'au prochain strpool_collect().
+const char *strpool_get(int id);
+size_t strpool_len(int id);
+int strpool_valid(int id);          // 1 si id désigne encore sa chaîne (0 : toujours valide)
+
+// Marque la chaîne comme encore référencée (identifiant gardé en cache)
+void strpool_touch(int id);
+
+// Libère les chaînes non référencées depuis STRPOOL_TTL. Peu coûteux hors
+// passage effectif (au plus une fois par STRPOOL_TTL / 4) : à appeler après
+// chaque collecte.
+void strpool_collect(void);
+
+// Occupation : nombre de chaînes vivantes, octets des blocs
+int strpool_count(void);
+size_t strpool_bytes(void);
+
+#endif
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "sysstats.h"
+#include "process.h"
+#include "profile.h"
+
+// Descripteurs gardés ouverts entre deux rafraîchissements : on relit avec
+// pread() à l'offset 0, ce qui évite open/close à chaque mesure.
+static int stat_fd = -1;
+static int meminfo_fd = -1;
+static int loadavg_fd = -1;
+static int psi_fds[3] = { -1, -1, -1 };   // pressure/cpu, memory, io
+static int psi_missing = 0;               // 1 : PSI absent, on ne réessaie plus
+
+// Tampon de lecture partagé, agrandi si un fichier ne tient pas dedans
+// (la ligne "intr" de /proc/stat peut dépasser plusieurs dizaines de Ko)
+static char *read_buf = NULL;
+static size_t read_cap = 0;
+
+static unsigned long cached_mem_total = 0;
+
+// Topologie NUMA : noeud de chaque coeur, lue une fois (elle ne change qu'au
+// branchement à chaud de mémoire ou de CPU)
+static signed char cpu_node[MAX_CPUS];
+static int numa_nodes = 0;                // 0 : pas encore lue
+
+// Lit entièrement un fichier de /proc dans read_buf en réutilisant le descripteur
+// Retourne la taille lue, ou -1
+static ssize_t read_proc_file(int *fd, const char *name) {
+    if (*fd < 0) {
+        char path[PROC_ROOT_MAX + 16];
+        snprintf(path, sizeof(path), "%s/%s", process_proc_root(), name);
+        *fd = open(path, O_RDONLY | O_CLOEXEC);
+        PROF_OPEN();
+        if (*fd < 0) return -1;
+    }
+    if (read_cap == 0) {
+        read_cap = 16384;
+        read_buf = malloc(read_cap);
+        if (!read_buf) { read_cap = 0; return -1; }
+    }
+
+    size_t len = 0;
+    while (1) {
+        ssize_t n = pread(*fd, read_buf + len, read_cap - len - 1, len);
+        PROF_READ(n > 0 ? n : 0);
+        if (n < 0) {
+            close(*fd);
+            *fd = -1;
+            return -1;
+        }
+        if (n == 0) break;
+        len += n;
+        if (len + 1 >= read_cap) { // plein : on double et on continue
+            char *tmp = realloc(read_buf, read_cap * 2);
+            if (!tmp) break;
+            read_buf = tmp;
+            read_cap *= 2;
+        }
+    }
+    read_buf[len] = '\0';
+    return len;
+}
+
+// Lecture d'un entier non signé, avance le curseur
+static unsigned long long parse_ull(const char **p) {
+    const char *s = *p;
+    unsigned long long v = 0;
+    while (*s == ' ') s++;
+    while (*s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+    *p = s;
+    return v;
+}
+
+// Lecture d'un décimal simple "12.34" (format de /proc/loadavg)
+static double parse_decimal(const char **p) {
+    const char *s = *p;
+    double v = (double)parse_ull(&s);
+    if (*s == '.') {
+        s++;
+        double scale = 0.1;
+        while (*s >= '0' && *s <= '9') { v += (*s++ - '0') * scale; scale /= 10; }
+    }
+    *p = s;
+    return v;
+}
+
+static const char *next_line(const char *s) {
+    const char *nl = strchr(s, '\n');
+    return nl ? nl + 1 : s + strlen(s);
+}
+
+static void parse_cpu_times(const char *s, CpuTimes *t) {
+    t->user    = parse_ull(&s);
+    t->nice    = parse_ull(&s);
+    t->system  = parse_ull(&s);
+    t->idle    = parse_ull(&s);
+    t->iowait  = parse_ull(&s);
+    t->irq     = parse_ull(&s);
+    t->softirq = parse_ull(&s);
+    t->steal   = parse_ull(&s);
+}
+
+unsigned long long sysstats_cpu_total(const CpuTimes *t) {
+    return t->user + t->nice + t->system + t->idle + t->iowait + t->irq + t->softirq + t->steal;
+}
+
+// % d'occupation entre deux mesures (idle et iowait comptent comme inactifs)
+static double cpu_busy_percent(const CpuTimes *cur, const CpuTimes *prev) {
+    unsigned long long total = sysstats_cpu_total(cur) - sysstats_cpu_total(prev);
+    unsigned long long idle  = (cur->idle + cur->iowait) - (prev->idle + prev->iowait);
+    if (total == 0 || idle > total) return 0.0;
+    return 100.0 * (total - idle) / total;
+}
+
+// /proc/stat : toutes les lignes cpu, ctxt, procs_running, procs_blocked
+static int parse_cpu_stat(SystemStats *st) {
+    if (read_proc_file(&stat_fd, "stat") <= 0) return 0;
+
+    int ncpu = 0;
+    const char *s = read_buf;
+    while (*s) {
+        if (strncmp(s, "cpu", 3) == 0) {
+            if (s[3] == ' ') {
+                parse_cpu_times(s + 4, &st->total);
+            } else if (ncpu < MAX_CPUS) {
+                const char *p = s + 3;
+                st->cpu_id[ncpu] = (int)parse_ull(&p); // numéro du coeur
+                parse_cpu_times(p, &st->cpus[ncpu++]);
+            }
+        } else if (strncmp(s, "ctxt ", 5) == 0) {
+            const char *p = s + 5;
+            st->ctxt = parse_ull(&p);
+        } else if (strncmp(s, "procs_running ", 14) == 0) {
+            const char *p = s + 14;
+            st->procs_running = (int)parse_ull(&p);
+        } else if (strncmp(s, "procs_blocked ", 14) == 0) {
+            const char *p = s + 14;
+            st->procs_blocked = (int)parse_ull(&p);
+        }
+        s = next_line(s);
+    }
+    st->cpu_count = ncpu;
+    return 1;
+}
+
+// /proc/meminfo : valeurs en kB converties en octets
+static int parse_meminfo(SystemStats *st) {
+    if (read_proc_file(&meminfo_fd, "meminfo") <= 0) return 0;
+
+    static const struct { const char *label; size_t off; } fields[] = {
+        { "MemTotal:",     offsetof(SystemStats, mem_total) },
+        { "MemFree:",      offsetof(SystemStats, mem_free) },
+        { "MemAvailable:", offsetof(SystemStats, mem_available) },
+        { "Buffers:",      offsetof(SystemStats, buffers) },
+        { "Cached:",       offsetof(SystemStats, cached) },
+        { "SwapTotal:",    offsetof(SystemStats, swap_total) },
+        { "SwapFree:",     offsetof(SystemStats, swap_free) },
+    };
+    const int nfields = sizeof(fields) / sizeof(fields[0]);
+
+    int found = 0;
+    const char *s = read_buf;
+    while (*s && found < nfields) {
+        for (int i = 0; i < nfields; i++) {
+            size_t len = strlen(fields[i].label);
+            if (strncmp(s, fields[i].label, len) == 0) {
+                const char *p = s + len;
+                *(unsigned long *)((char *)st + fields[i].off) = parse_ull(&p) * 1024;
+                found++;
+                break;
+            }
+        }
+        s = next_line(s);
+    }
+    cached_mem_total = st->mem_total;
+    return 1;
+}
+
+// /proc/loadavg : "0.12 0.34 0.56 2/345 6789"
+static int parse_loadavg(SystemStats *st) {
+    if (read_proc_file(&loadavg_fd, "loadavg") <= 0) return 0;
+
+    const char *s = read_buf;
+    for (int i = 0; i < 3; i++) {
+        st->load[i] = parse_decimal(&s);
+        while (*s == ' ') s++;
+    }
+    st->tasks_running = (int)parse_ull(&s);
+    if (*s == '/') s++;
+    st->tasks_total = (int)parse_ull(&s);
+    return 1;
+}
+
+// Valeur avg10 de la ligne "some" ou "full" d'un fichier de /proc/pressure :
+// "some avg10=1.23 avg60=0.50 avg300=0.10 total=123456"
+static double parse_psi_avg10(const char *kind) {
+    const char *s = read_buf;
+    while (*s && strncmp(s, kind, 4) != 0) s = next_line(s);
+    const char *p = *s ? strstr(s, "avg10=") : NULL;
+    if (!p) return 0.0;
+    p += 6;
+    return parse_decimal(&p);
+}
+
+// /proc/pressure/{cpu,memory,io} : temps perdu à attendre le CPU, la mémoire ou les disques
+static int parse_pressure(SystemStats *st) {
+    static const char *names[3] = { "pressure/cpu", "pressure/memory", "pressure/io" };
+    double some[3], full[3];
+    if (psi_missing) return 0;
+    for (int i = 0; i < 3; i++) {
+        if (read_proc_file(&psi_fds[i], names[i]) <= 0) {
+            psi_missing = 1; // open refusé ou EOPNOTSUPP (psi=0) : pas de nouvel essai à chaque trame
+            st->psi_valid = 0;
+            return 0;
+        }
+        some[i] = parse_psi_avg10("some");
+        full[i] = parse_psi_avg10("full");
+    }
+    st->psi_cpu_some = some[0];
+    st->psi_mem_some = some[1];
+    st->psi_mem_full = full[1];
+    st->psi_io_some = some[2];
+    st->psi_io_full = full[2];
+    st->psi_valid = 1;
+    return 1;
+}
+
+// Lit nodeN/cpulist ("0-15,32-47") pour chaque noeud. Sans ce répertoire
+// (noyau sans CONFIG_NUMA), tous les coeurs sont sur le noeud 0.
+static void load_numa_topology(void) {
+    memset(cpu_node, 0, sizeof(cpu_node));
+    numa_nodes = 1;
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (!dir) return;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) != 0 || entry->d_name[4] < '0' || entry->d_name[4] > '9') continue;
+        int node = atoi(entry->d_name + 4);
+        if (node >= MAX_NUMA_NODES) continue;
+
+        char path[300], list[1024];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/%s/cpulist", entry->d_name);
+        FILE *f = fopen(path, "r");
+        if (!f) continue;
+        if (!fgets(list, sizeof(list), f)) list[0] = '\0';
+        fclose(f);
+
+        const char *p = list;
+        while (*p >= '0' && *p <= '9') {
+            int lo = (int)parse_ull(&p), hi = lo;
+            if (*p == '-') { p++; hi = (int)parse_ull(&p); }
+            for (int cpu = lo; cpu <= hi && cpu < MAX_CPUS; cpu++) cpu_node[cpu] = (signed char)node;
+            if (*p == ',') p++;
+        }
+        if (node + 1 > numa_nodes) numa_nodes = node + 1;
+    }
+    closedir(dir);
+}
+
+int sysstats_cpu_node(int cpu) {
+    if (cpu < 0 || cpu >= MAX_CPUS) return -1;
+    if (numa_nodes == 0) load_numa_topology();
+    return cpu_node[cpu];
+}
+
+// Charge par noeud : moyenne des coeurs déjà mesurés, sans autre lecture
+static void update_nodes(SystemStats *st) {
+    if (numa_nodes == 0) load_numa_topology();
+    st->numa_nodes = numa_nodes;
+    memset(st->node_percent, 0, sizeof(st->node_percent));
+    memset(st->node_cpus, 0, sizeof(st->node_cpus));
+    for (int i = 0; i < st->cpu_count; i++) {
+        int node = sysstats_cpu_node(st->cpu_id[i]);
+        if (node < 0) continue;
+        st->node_percent[node] += st->cpu_percent[i];
+        st->node_cpus[node]++;
+    }
+    for (int n = 0; n < numa_nodes; n++) {
+        if (st->node_cpus[n] > 0) st->node_percent[n] /= st->node_cpus[n];
+    }
+}
+
+static double monotonic_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int sysstats_update(SystemStats *st) {
+    unsigned long long prev_ctxt = st->ctxt;
+    double prev_sample = st->last_sample;
+
+    st->prev_total = st->total;
+    memcpy(st->prev_cpus, st->cpus, sizeof(st->cpus));
+
+    if (!parse_cpu_stat(st)) return 0;
+    parse_meminfo(st);
+    parse_loadavg(st);
+    parse_pressure(st);
+
+    st->last_sample = monotonic_now();
+    if (st->samples > 0) {
+        st->total_percent = cpu_busy_percent(&st->total, &st->prev_total);
+        for (int i = 0; i < st->cpu_count; i++) {
+            st->cpu_percent[i] = cpu_busy_percent(&st->cpus[i], &st->prev_cpus[i]);
+        }
+        double elapsed = st->last_sample - prev_sample;
+        st->ctxt_rate = (elapsed > 0) ? (st->ctxt - prev_ctxt) / elapsed : 0.0;
+    }
+    update_nodes(st);
+    st->samples++;
+    return 1;
+}
+
+unsigned long long sysstats_read_cpu_total(void) {
+    if (read_proc_file(&stat_fd, "stat") <= 0) return 0;
+    if (strncmp(read_buf, "cpu ", 4) != 0) return 0;
+    CpuTimes t;
+    parse_cpu_times(read_buf + 4, &t);
+    return sysstats_cpu_total(&t);
+}
+
+unsigned long sysstats_mem_total(void) {
+    if (cached_mem_total == 0) {
+        SystemStats tmp = {0};
+        parse_meminfo(&tmp);
+    }
+    return cached_mem_total;
+}
+
+void sysstats_close(void) {
+    if (stat_fd >= 0) { close(stat_fd); stat_fd = -1; }
+    if (meminfo_fd >= 0) { close(meminfo_fd); meminfo_fd = -1; }
+    if (loadavg_fd >= 0) { close(loadavg_fd); loadavg_fd = -1; }
+    for (int i = 0; i < 3; i++) {
+        if (psi_fds[i] >= 0) { close(psi_fds[i]); psi_fds[i] = -1; }
+    }
+    free(read_buf);
+    read_buf = NULL;
+    read_cap = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef SYSSTATS_H
+#define SYSSTATS_H
+
+#define MAX_CPUS 256
+#define MAX_NUMA_NODES 16
+
+// Compteurs d'une ligne "cpu" de /proc/stat (en ticks)
+typedef struct {
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+} CpuTimes;
+
+// Statistiques système globales (en-tête façon htop)
+typedef struct {
+    int cpu_count;
+    CpuTimes total;                 // ligne "cpu" agrégée
+    CpuTimes cpus[MAX_CPUS];        // lignes "cpuN"
+    CpuTimes prev_total;            // mesure précédente, pour les deltas
+    CpuTimes prev_cpus[MAX_CPUS];
+    double total_percent;           // utilisation globale entre 2 mesures
+    double cpu_percent[MAX_CPUS];   // utilisation par coeur entre 2 mesures
+    int cpu_id[MAX_CPUS];           // numéro de chaque ligne "cpuN" (coeurs hors ligne absents)
+
+    // Noeuds NUMA (topologie de /sys/devices/system/node, lue une fois)
+    int numa_nodes;                 // 1 : machine non NUMA
+    double node_percent[MAX_NUMA_NODES]; // moyenne des coeurs en ligne du noeud
+    int node_cpus[MAX_NUMA_NODES];  // coeurs en ligne du noeud
+
+    unsigned long long ctxt;        // changements de contexte depuis le boot
+    double ctxt_rate;               // changements de contexte par seconde
+    int procs_running;
+    int procs_blocked;
+
+    // /proc/meminfo, en octets
+    unsigned long mem_total;
+    unsigned long mem_free;
+    unsigned long mem_available;
+    unsigned long buffers;
+    unsigned long cached;
+    unsigned long swap_total;
+    unsigned long swap_free;
+
+    // /proc/loadavg
+    double load[3];
+    int tasks_running;
+    int tasks_total;
+
+    // /proc/pressure/{cpu,memory,io} (PSI, noyau >= 4.20) : moyennes sur 10 s, en %
+    // some : au moins une tâche bloquée faute de la ressource, full : toutes
+    int psi_valid;                  // 0 : PSI absent (CONFIG_PSI, psi=0 au démarrage)
+    double psi_cpu_some;
+    double psi_mem_some, psi_mem_full;
+    double psi_io_some, psi_io_full;
+
+    double last_sample;             // horodatage monotone (s) de la mesure
+    int samples;                    // nombre de mesures effectuées
+} SystemStats;
+
+// Relit /proc/stat, /proc/meminfo, /proc/loadavg et /proc/pressure/* (une lecture chacun)
+// et calcule les deltas par rapport à la mesure précédente. Retourne 1 si ok.
+int sysstats_update(SystemStats *st);
+
+// Somme des ticks d'une ligne cpu
+unsigned long long sysstats_cpu_total(const CpuTimes *t);
+
+// Ticks CPU totaux (ligne "cpu" seule) sans mettre à jour de SystemStats
+unsigned long long sysstats_read_cpu_total(void);
+
+// MemTotal en octets, issu de la dernière lecture de /proc/meminfo
+unsigned long sysstats_mem_total(void);
+
+// Noeud NUMA d'un coeur (0 sur une machine non NUMA), -1 si cpu est hors limites
+int sysstats_cpu_node(int cpu);
+
+// Ferme les descripteurs conservés entre deux rafraîchissements
+void sysstats_close(void);
+
+#endif
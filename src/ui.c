@@ -6,63 +6,435 @@
 #include <sys/select.h>
 #include <signal.h>
 #include <errno.h>
+#include <sys/ioctl.h>
 #include "process.h"
 #include "ui.h" 
+#include "filter.h"
+#include "fmt.h"
+#include "profile.h"
+#include "alert.h"
 
 int command_handling(char*);
 void trim_newline(char*);
 
 // format_size 
 void format_size(unsigned long bytes, char *buf, size_t buf_size) {
-    if (bytes >= 1024UL * 1024UL * 1024UL) {
-        snprintf(buf, buf_size, "%.1fG", bytes / (1024.0 * 1024.0 * 1024.0));
-    } else if (bytes >= 1024UL * 1024UL) {
-        snprintf(buf, buf_size, "%.1fM", bytes / (1024.0 * 1024.0));
-    } else if (bytes >= 1024UL) {
-        snprintf(buf, buf_size, "%.1fK", bytes / 1024.0);
+    char tmp[32];
+    int len = fmt_size(tmp, bytes); // arithmétique entière, voir fmt.c
+    if ((size_t)len >= buf_size) len = buf_size - 1;
+    memcpy(buf, tmp, len);
+    buf[len] = '\0';
+}
+
+// ----------- viewport -----------------
+static int term_rows = 0;                      // 0 : sortie non interactive, pas de limite
+static int term_cols = 0;                      // idem : lignes de processus coupées à cette largeur
+static volatile sig_atomic_t winch_pending = 1; // taille du terminal à (re)lire
+static int lines_used = 0;                     // lignes déjà écrites dans la trame courante
+static int scroll_offset = 0;                  // première ligne de processus affichée
+static int page_rows = 20;                     // nombre de lignes de processus visibles
+static int profile_footer = 0;                 // pied de page de débogage (touche D)
+
+#define PROFILE_FOOTER_LINES 2
+
+static void on_sigwinch(int sig) {
+    (void)sig;
+    winch_pending = 1;
+}
+
+static void update_winsize(void) {
+    struct winsize ws;
+    if (isatty(STDOUT_FILENO) && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) {
+        term_rows = ws.ws_row;
+        term_cols = ws.ws_col;
     } else {
-        snprintf(buf, buf_size, "%luB", bytes);
+        term_rows = 0;
+        term_cols = 0;
+    }
+    winch_pending = 0;
+}
+
+void ui_init(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigwinch;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGWINCH, &sa, NULL);
+    update_winsize();
+}
+
+void ui_cleanup(void) {
+    signal(SIGWINCH, SIG_DFL);
+}
+
+int ui_resized(void) {
+    return winch_pending;
+}
+
+// Efface l'écran (séquence ANSI, sans fork de "clear") et démarre une trame
+void ui_begin_frame(const char *title) {
+    printf("\033[H\033[2J");
+    lines_used = 0;
+    if (title) {
+        printf("%s\n", title);
+        lines_used++;
+    }
+}
+
+void ui_set_profile_footer(int enabled) {
+    profile_footer = enabled;
+}
+
+// ui_print_profile : temps par phase et coût de l'outil sur une trame (2 lignes, sans '\n' final)
+void ui_print_profile(const ProfReport *r) {
+    printf("prof [%s] trame %.2fms  cpu outil %.2f%% |", r->source, r->frame_ms, r->self_cpu_percent);
+    for (int i = 0; i < PROF_NPHASES; i++) {
+        if (r->phase_ms[i] > 0) printf(" %s %.2f", prof_phase_names[i], r->phase_ms[i]);
+    }
+    char bytes_buf[16];
+    format_size(r->counters.bytes_read, bytes_buf, sizeof(bytes_buf));
+    printf(" ms\nprof fichiers ouverts %lu  lus %s  appels système %lu",
+           r->counters.files_opened, bytes_buf, r->counters.syscalls);
+}
+
+// Pied de page : bilan de la trame précédente (la courante n'est pas finie)
+static void print_profile_footer(void) {
+    if (!profile_footer) return;
+    if (term_rows == 0) printf("\n");
+    ui_print_profile(prof_last_frame());
+    if (term_rows == 0) printf("\n"); // en mode terminal, pas de défilement
+}
+
+void ui_scroll(int delta) {
+    scroll_offset += delta;
+    if (scroll_offset < 0) scroll_offset = 0; // la borne haute dépend du nombre de lignes, vue au rendu
+}
+
+void ui_scroll_pages(int pages) {
+    ui_scroll(pages * page_rows);
+}
+
+void ui_page_window(int count, int *first, int *last) {
+    if (winch_pending) update_winsize();
+    *first = 0;
+    *last = count;
+    if (term_rows == 0) return;
+    // au rendu, scroll_offset est ramené à count - page_rows au plus, et page_rows <= term_rows
+    int lowest = (count > term_rows) ? count - term_rows : 0;
+    *first = (scroll_offset < lowest) ? scroll_offset : lowest;
+    if (scroll_offset + term_rows < count) *last = scroll_offset + term_rows;
+}
+
+int ui_rows_needed(void) {
+    if (winch_pending) update_winsize();
+    if (term_rows == 0) return 0;
+    return scroll_offset + term_rows; // borne haute : la page ne dépasse jamais le terminal
+}
+
+// print_bar : jauge façon htop "label[||||||      42.0%]"
+static void print_bar(const char *label, double percent, const char *text, int width) {
+    char fill[128];
+    if (width > (int)sizeof(fill) - 1) width = sizeof(fill) - 1;
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+
+    int len = (int)strlen(text);
+    int bars = (int)(percent * width / 100.0 + 0.5);
+    for (int i = 0; i < width; i++) {
+        fill[i] = (i < bars) ? '|' : ' ';
     }
+    // le texte est écrit à droite, par-dessus la jauge
+    if (len <= width) memcpy(fill + width - len, text, len);
+    fill[width] = '\0';
+    printf("%4s[%s]", label, fill);
+}
+
+// ui_print_meters : en-tête système (coeurs, mémoire, swap, charge)
+void ui_print_meters(const SystemStats *st) {
+    char label[12], text[48];
+    const int columns = (st->cpu_count > 8) ? 2 : 1;
+    const int width = (columns == 2) ? 30 : 66;
+    int rows = (st->cpu_count + columns - 1) / columns;
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            int cpu = r + c * rows;
+            if (cpu >= st->cpu_count) break;
+            snprintf(label, sizeof(label), "%d", cpu);
+            snprintf(text, sizeof(text), "%.1f%%", st->cpu_percent[cpu]);
+            print_bar(label, st->cpu_percent[cpu], text, width);
+            printf("  ");
+        }
+        printf("\n");
+    }
+
+    char used_buf[16], total_buf[16];
+    unsigned long used = st->mem_total - st->mem_available;
+    format_size(used, used_buf, sizeof(used_buf));
+    format_size(st->mem_total, total_buf, sizeof(total_buf));
+    snprintf(text, sizeof(text), "%s/%s", used_buf, total_buf);
+    print_bar("Mem", st->mem_total ? 100.0 * used / st->mem_total : 0.0, text, 66);
+    printf("\n");
+
+    unsigned long swap_used = st->swap_total - st->swap_free;
+    format_size(swap_used, used_buf, sizeof(used_buf));
+    format_size(st->swap_total, total_buf, sizeof(total_buf));
+    snprintf(text, sizeof(text), "%s/%s", used_buf, total_buf);
+    print_bar("Swp", st->swap_total ? 100.0 * swap_used / st->swap_total : 0.0, text, 66);
+    printf("\n");
+
+    if (st->numa_nodes > 1) { // charge moyenne des coeurs de chaque noeud, deux par ligne
+        int node_rows = (st->numa_nodes + 1) / 2;
+        for (int r = 0; r < node_rows; r++) {
+            for (int n = r * 2; n < st->numa_nodes && n < r * 2 + 2; n++) {
+                snprintf(label, sizeof(label), "N%d", n);
+                snprintf(text, sizeof(text), "%d cpu %.1f%%", st->node_cpus[n], st->node_percent[n]);
+                print_bar(label, st->node_percent[n], text, 30);
+                printf("  ");
+            }
+            printf("\n");
+        }
+        lines_used += node_rows;
+    }
+
+    printf("  Tasks: %d, %d running, %d blocked   Load average: %.2f %.2f %.2f   Ctxt/s: %.0f   CPU: %.1f%%\n",
+           st->tasks_total, st->procs_running, st->procs_blocked,
+           st->load[0], st->load[1], st->load[2], st->ctxt_rate, st->total_percent);
+    lines_used += rows + 4; // coeurs, Mem, Swp, Tasks, ligne vide
+    if (st->psi_valid) { // pression sur 10 s : some (au moins une tâche bloquée) / full (toutes)
+        printf("  Pressure avg10 some/full: cpu %.2f%%   mem %.2f%%/%.2f%%   io %.2f%%/%.2f%%\n",
+               st->psi_cpu_some, st->psi_mem_some, st->psi_mem_full, st->psi_io_some, st->psi_io_full);
+        lines_used++;
+    }
+    printf("\n");
+}
+
+// Colonnes optionnelles
+static int show_io_columns = 0;
+
+void ui_set_io_columns(int enabled) {
+    show_io_columns = enabled;
+}
+
+static int show_smaps_columns = 0;
+
+void ui_set_smaps_columns(int enabled) {
+    show_smaps_columns = enabled;
+}
+
+static int show_delay_column = 0;
+
+void ui_set_delay_column(int enabled) {
+    show_delay_column = enabled;
+}
+
+static int show_numa_columns = 0;
+
+void ui_set_numa_columns(int enabled) {
+    show_numa_columns = enabled;
 }
 
 // print_header
 void print_header() {
-    printf("%-6s %-17s %-4s %-4s %-10s %-10s %-10s %-3s %-6s %-6s %-10s %-20s\n",
-           "PID", "USER", "PRI", "NI", "VIRT", "RES", "SHR", "S", "MEM%", "CPU%", "TIME", "CMD");
+    printf("%-6s %-17s %-4s %-4s %-10s %-10s %-10s ",
+           "PID", "USER", "PRI", "NI", "VIRT", "RES", "SHR");
+    if (show_smaps_columns) printf("%-10s %-10s %-10s ", "PSS", "USS", "SWAP");
+    printf("%-3s %-6s %-6s ", "S", "MEM%", "CPU%");
+    if (show_delay_column) printf("%-6s ", "DLY%");
+    if (show_numa_columns) printf("%-4s %-4s %-12s ", "PSR", "NODE", "AFFINITY");
+    printf("%-10s ", "TIME");
+    if (show_io_columns) printf("%-10s %-10s ", "RD/s", "WR/s");
+    printf("%-20s\n", "CMD");
 }
 
-// print_process
-void print_process(const ProcessInfo *info, int is_initial_run) {
-    char virt_buf[16], res_buf[16], shr_buf[16];
-    format_size(info->virt, virt_buf, sizeof(virt_buf));
-    format_size(info->res,  res_buf, sizeof(res_buf));
-    format_size(info->shr,  shr_buf, sizeof(shr_buf));
+// print_io : débits disque, "-" si non disponibles (accès refusé, hôte distant)
+static void print_io(LineBuf *lb, const ProcessInfo *info) {
+    if (info->io_valid) {
+        lb_put_size(lb, (unsigned long)info->io_read_rate, 10, 1);
+        lb_put_size(lb, (unsigned long)info->io_write_rate, 10, 1);
+    } else {
+        lb_put_str(lb, "-", 10, 1);
+        lb_put_str(lb, "-", 10, 1);
+    }
+}
 
+// print_numa : dernier coeur, noeud et coeurs autorisés ("-" si inconnus : hôte
+// distant, status pas encore lu). Liste trop longue coupée, terminée par '+'
+static void print_numa(LineBuf *lb, const ProcessInfo *info) {
+    if (info->last_cpu >= 0) lb_put_int(lb, info->last_cpu, 4, 1);
+    else lb_put_str(lb, "-", 4, 1);
+    if (info->numa_node >= 0) lb_put_int(lb, info->numa_node, 4, 1);
+    else lb_put_str(lb, "-", 4, 1);
+    const char *cpus = process_affinity(info);
+    char cut[13];
+    if (strlen(cpus) > 12) {
+        memcpy(cut, cpus, 11);
+        cut[11] = '+';
+        cut[12] = '\0';
+        cpus = cut;
+    }
+    lb_put_str(lb, cpus[0] ? cpus : "-", 12, 1);
+}
+
+// print_smaps : PSS/USS/SWAP en cache, "-" si pas encore lus ou illisibles
+static void print_smaps(LineBuf *lb, const ProcessInfo *info) {
+    if (info->smaps_valid) {
+        lb_put_size(lb, info->pss, 10, 1);
+        lb_put_size(lb, info->uss, 10, 1);
+        lb_put_size(lb, info->swap, 10, 1);
+    } else {
+        lb_put_str(lb, "-", 10, 1);
+        lb_put_str(lb, "-", 10, 1);
+        lb_put_str(lb, "-", 10, 1);
+    }
+}
+
+// ui_format_process
+// Écrit la ligne d'un processus dans lb (mêmes colonnes que print_header)
+// prefix : préfixe d'arborescence ajouté devant CMD (lignes de thread)
+void ui_format_process(LineBuf *lb, const ProcessInfo *info, int is_initial_run, const char *prefix) {
+    lb_reset(lb);
+    lb_put_int(lb, info->pid, 6, 1);
+    lb_put_str(lb, process_user(info), 17, 1);
+    lb_put_int(lb, info->priority, 4, 1);
+    lb_put_int(lb, info->nice, 4, 1);
+    lb_put_size(lb, info->virt, 10, 1);
+    lb_put_size(lb, info->res, 10, 1);
+    lb_put_size(lb, info->shr, 10, 1);
+    if (show_smaps_columns) print_smaps(lb, info);
+    lb_put_char(lb, info->state, 3, 1);
+    lb_put_fixed(lb, info->mem_percent, 2, 6, 1);
     if (is_initial_run) {
-        printf("%-6d %-17s %-4ld %-4ld %-10s %-10s %-10s %-3c %-6.2f %-6s %-10lu %-20s\n",
-               info->pid, info->user,
-               info->priority, info->nice,
-               virt_buf, res_buf, shr_buf,
-               info->state, info->mem_percent,
-               "-", // Remplacement par un tiret
-               info->time, info->name);
+        lb_put_str(lb, "-", 6, 1); // Remplacement par un tiret
+    } else {
+        lb_put_fixed(lb, info->cpu_percent, 2, 6, 1);
+    }
+    if (show_delay_column) { // attente d'un CPU, "-" sans mesure précédente ou hôte distant
+        if (info->sched_valid) lb_put_fixed(lb, info->sched_delay, 2, 6, 1);
+        else lb_put_str(lb, "-", 6, 1);
+    }
+    if (show_numa_columns) print_numa(lb, info);
+    lb_put_uint(lb, info->time, 10, 1);
+    if (show_io_columns) print_io(lb, info);
+
+    lb_put_str(lb, prefix, 0, 0);
+    if (info->children > 0) { // vue arborescente : cumul du sous-arbre en tête, la commande peut être longue
+        lb_put_str(lb, "[sub: ", 0, 0);
+        lb_put_fixed(lb, info->tree_cpu, 1, 0, 0);
+        lb_put_str(lb, "% cpu, ", 0, 0);
+        lb_put_fixed(lb, info->tree_mem, 1, 0, 0);
+        lb_put_str(lb, "% mem] ", 0, 0);
+    }
+    // ligne de commande complète ; nom court pour un thread (son nom propre)
+    // ou un processus sans ligne de commande (thread noyau, zombie)
+    if (info->is_thread) {
+        lb_put_str(lb, process_name(info), 0, 0);
+    } else if (info->cmd_id == 0) {
+        lb_put_str(lb, "[", 0, 0);
+        lb_put_str(lb, process_name(info), 0, 0);
+        lb_put_str(lb, "]", 0, 0);
     } else {
-        printf("%-6d %-17s %-4ld %-4ld %-10s %-10s %-10s %-3c %-6.2f %-6.2f %-10lu %-20s\n",
-               info->pid, info->user,
-               info->priority, info->nice,
-               virt_buf, res_buf, shr_buf,
-               info->state, info->mem_percent,
-               info->cpu_percent, 
-               info->time, info->name);
+        lb_put_str(lb, process_cmdline(info), 0, 0);
+    }
+    lb_newline(lb);
+}
+
+// print_process
+void print_process(const ProcessInfo *info, int is_initial_run, const char *prefix) {
+    LineBuf lb;
+    ui_format_process(&lb, info, is_initial_run, prefix);
+    // une ligne de commande longue ne doit pas passer à la ligne (octets :
+    // coupe un peu tôt si la ligne contient de l'UTF-8, jamais au milieu d'un caractère)
+    if (term_cols > 0 && lb.len > (size_t)term_cols + 1) {
+        size_t n = term_cols;
+        while (n > 0 && ((unsigned char)lb.data[n] & 0xC0) == 0x80) n--;
+        lb.data[n] = '\n';
+        lb.data[n + 1] = '\0';
+        lb.len = n + 1;
+    }
+    fwrite(lb.data, 1, lb.len, stdout);
+}
+
+// tree_prefix : traits d'arborescence d'après depth et tree_mask
+static void tree_prefix(const ProcessInfo *info, char *buf, size_t size) {
+    size_t len = 0;
+    buf[0] = '\0';
+    for (int l = 0; l < info->depth && len + 8 < size; l++) {
+        int more = (l < 64) && (info->tree_mask & (1ULL << l));
+        const char *part;
+        if (l < info->depth - 1) part = more ? "│  " : "   ";
+        else                     part = more ? "├─ " : "└─ ";
+        len += snprintf(buf + len, size - len, "%s", part);
     }
 }
 
 void ui_refresh_process_list(ProcessInfo processes[], int count, int is_initial_run) {
     //system("clear"); la gestion de l'effaçage est désormais gérée dans manager.c afin de manipuler sans problème les différents headers possibles
+    char tree_buf[128];
+    if (winch_pending) update_winsize();
+
+    // Seules les lignes visibles sont formatées : en-tête + barre d'état en bas
+    int first = 0, last = count;
+    int alert_line = (alert_event_count() > 0); // dernier déclenchement, au-dessus de la barre d'état
+    if (term_rows > 0) {
+        page_rows = term_rows - lines_used - 2 - alert_line - (profile_footer ? PROFILE_FOOTER_LINES : 0);
+        if (page_rows < 1) page_rows = 1;
+        if (scroll_offset > count - page_rows) scroll_offset = count - page_rows;
+        if (scroll_offset < 0) scroll_offset = 0;
+        first = scroll_offset;
+        last = (first + page_rows < count) ? first + page_rows : count;
+    }
+
+    process_fill_rows(processes + first, last - first); // champs différés : page affichée seulement
     print_header();
+    for (int i = first; i < last; i++) {
+        const char *prefix = "";
+        if (processes[i].is_thread) { // mode thread : les threads suivent leur processus
+            int is_last = (i + 1 >= count || !processes[i + 1].is_thread);
+            prefix = is_last ? " └─ " : " ├─ ";
+        } else if (processes[i].depth > 0) { // vue arborescente
+            tree_prefix(&processes[i], tree_buf, sizeof(tree_buf));
+            prefix = tree_buf;
+        }
+        // règle d'alerte : vidéo inverse si déclenchée, gras tant que la durée n'est pas atteinte
+        if (processes[i].alert) printf(processes[i].alert == ALERT_FIRING ? "\033[7m" : "\033[1m");
+        print_process(&processes[i], is_initial_run, prefix);
+        if (processes[i].alert) printf("\033[0m");
+    }
+    if (alert_line) printf("Alertes: %lu | %.150s\n", alert_event_count(), alert_last_event());
+    if (term_rows > 0) { // pas de retour à la ligne : le terminal ne défile pas
+        printf("-- %d-%d / %d -- haut/bas, PgUp/PgDn : défilement", count ? first + 1 : 0, last, count);
+        if (profile_footer) printf("\n");
+    }
+    print_profile_footer();
+    fflush(stdout);
+}
+
+// ui_print_cgroups : vue conteneurs, un cgroup par ligne
+void ui_print_cgroups(const CgroupStats groups[], int count) {
+    char rss_buf[16], exact_mem_buf[16], exact_cpu_buf[16];
+    printf("%-6s %-8s %-10s %-6s %-9s %-10s %s\n",
+           "PROCS", "CPU%", "RES", "MEM%", "CG CPU%", "CG MEM", "CGROUP");
     for (int i = 0; i < count; i++) {
-        print_process(&processes[i], is_initial_run);
+        const CgroupStats *g = &groups[i];
+        format_size(g->rss, rss_buf, sizeof(rss_buf));
+        if (g->exact_valid) { // compteurs du cgroup v2 (inclut le cache de pages, les processus sortis...)
+            format_size(g->exact_mem, exact_mem_buf, sizeof(exact_mem_buf));
+            snprintf(exact_cpu_buf, sizeof(exact_cpu_buf), "%.2f", g->exact_cpu_percent);
+        } else {
+            strcpy(exact_mem_buf, "-");
+            strcpy(exact_cpu_buf, "-");
+        }
+        // on garde la fin du chemin, qui porte l'identifiant du conteneur
+        const char *path = g->path;
+        size_t len = strlen(path);
+        if (len > 70) path += len - 70;
+        printf("%-6d %-8.2f %-10s %-6.2f %-9s %-10s %s\n",
+               g->procs, g->cpu_percent, rss_buf, g->mem_percent,
+               exact_cpu_buf, exact_mem_buf, path);
     }
+    print_profile_footer();
     fflush(stdout);
 }
 
@@ -108,7 +480,7 @@ int keyhit_check(void){
     fd_set fds; //dummy list of tracked files
     FD_ZERO(&fds); //reset tracked files 
     FD_SET(STDIN_FILENO, &fds); //set tracked files to the one storing input buffer
-    return select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv); //select() function that tells whether or not buffer is empty 
+    return select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0; //select() function that tells whether or not buffer is empty (-1 : interrupted by SIGWINCH)
 }
 
 //key logic 
@@ -145,8 +517,30 @@ int command_handling(char *command){
     /*printf("action : %s",action);
     getchar();*/
     if (strcmp(action,"help")==0 || strcmp(action, "h") == 0){
-        printf("help | h : displays available commands\nkill <pid> : terminate the <pid> process\npause <pid> : freezes the <pid> process\nresume <pid> : unfreezes the <pid> process\nrestart <pid> : reload the <pid> process");
+        printf("help | h : displays available commands\nkill <pid> : terminate the <pid> process\npause <pid> : freezes the <pid> process\nresume <pid> : unfreezes the <pid> process\nrestart <pid> : reload the <pid> process\nthreads <pid> : show/hide the threads of <pid> (thread mode, key H)\nfilter <expr> : only show matching processes, e.g. 'user=postgres cpu>5 name~java' (no expr : clear)");
         
+    }else if(strcmp(action,"filter")==0){
+        char *expr = strtok(NULL,"\n");
+        char err[128];
+        if(filter_set_active(expr ? expr : "", err, sizeof(err)) != 0){
+            printf("error : %s",err);
+        }else{
+            printf("filter %s",expr ? "set" : "cleared");
+        }
+    }else if(strcmp(action,"threads")==0){
+        char *pid_c = strtok(NULL," \n\t");
+        char *endptr;
+        long pid = pid_c ? strtol(pid_c,&endptr,10) : 0;
+        if(!pid_c || *endptr != '\0' || pid<=0){
+            printf("error : invalid <pid>");
+        }else{
+            int state = process_toggle_threads((int)pid);
+            if(state < 0){
+                printf("error : too many expanded processes");
+            }else{
+                printf("threads of %ld %s", pid, state ? "expanded" : "collapsed");
+            }
+        }
     }else if(strcmp(action,"quit")==0 || strcmp(action, "q") ==0){
         exit(0);
         //slight redundancy in exit methods - enhanced user experience
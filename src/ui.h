@@ -2,11 +2,31 @@
 #define UI_H
 
 #include "process.h" // Nécessaire pour ProcessInfo
+#include "sysstats.h" // Nécessaire pour SystemStats
+#include "cgroup.h" // Nécessaire pour CgroupStats
+#include "fmt.h" // Nécessaire pour LineBuf
+#include "profile.h" // Nécessaire pour ProfReport
 
 // Fonctions d'interface
 void ui_init(void);
 void ui_cleanup(void);
+void ui_begin_frame(const char *title); // efface l'écran, title peut être NULL
+int ui_resized(void);                   // 1 si SIGWINCH reçu depuis le dernier rendu
+void ui_scroll(int delta);              // défilement de la liste, en lignes
+void ui_scroll_pages(int pages);        // défilement, en pages
+int ui_rows_needed(void);               // lignes à trier pour la page courante (0 : toutes)
+// Lignes [first, last) qui contiennent à coup sûr la prochaine page affichée
+void ui_page_window(int count, int *first, int *last);
 void ui_refresh_process_list(ProcessInfo processes[], int count, int is_initial_run);
+void ui_print_meters(const SystemStats *st);
+void ui_format_process(LineBuf *lb, const ProcessInfo *info, int is_initial_run, const char *prefix);
+void ui_set_io_columns(int enabled); // colonnes RD/s WR/s
+void ui_set_smaps_columns(int enabled); // colonnes PSS USS SWAP
+void ui_set_delay_column(int enabled); // colonne DLY% (attente en file d'exécution)
+void ui_set_numa_columns(int enabled); // colonnes PSR NODE AFFINITY (placement)
+void ui_print_cgroups(const CgroupStats groups[], int count);
+void ui_set_profile_footer(int enabled); // pied de page de profilage
+void ui_print_profile(const ProfReport *r);
 
 //fonctions de paramètres clavier 
 void term_init(void);
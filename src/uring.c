@@ -0,0 +1,163 @@
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "uring.h"
+#include "profile.h"
+
+// Anneaux partagés avec le noyau (un seul émetteur : pas de verrou)
+static int ring_fd = -1;
+static unsigned sq_entries, cq_entries;
+static unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_sqe *sqes;
+static struct io_uring_cqe *cqes;
+static void *sq_ring, *cq_ring;
+static size_t sq_ring_size, cq_ring_size, sqes_size;
+
+static int sys_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    PROF_SYSCALL();
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int ring_map(void) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    ring_fd = sys_setup(URING_ENTRIES, &p);
+    if (ring_fd < 0) return -1;
+    sq_entries = p.sq_entries;
+    cq_entries = p.cq_entries;
+
+    sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    // noyaux >= 5.4 : les deux anneaux partagent un seul mapping
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (cq_ring_size > sq_ring_size) sq_ring_size = cq_ring_size;
+        cq_ring_size = sq_ring_size;
+    }
+    sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) { sq_ring = NULL; return -1; }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        cq_ring = sq_ring;
+    } else {
+        cq_ring = mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) { cq_ring = NULL; return -1; }
+    }
+    sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) { sqes = NULL; return -1; }
+
+    char *sq = sq_ring, *cq = cq_ring;
+    sq_head = (unsigned *)(sq + p.sq_off.head);
+    sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    sq_array = (unsigned *)(sq + p.sq_off.array);
+    cq_head = (unsigned *)(cq + p.cq_off.head);
+    cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+void uring_close(void) {
+    if (sqes) munmap(sqes, sqes_size);
+    if (cq_ring && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+    if (sq_ring) munmap(sq_ring, sq_ring_size);
+    if (ring_fd >= 0) close(ring_fd);
+    sqes = NULL;
+    sq_ring = cq_ring = NULL;
+    ring_fd = -1;
+}
+
+int uring_active(void) {
+    return ring_fd >= 0;
+}
+
+int uring_init(void) {
+    if (ring_fd >= 0) return 0;
+    if (ring_map() != 0) {
+        uring_close();
+        return -1;
+    }
+    // IORING_OP_READ n'existe que depuis 5.6 : on vérifie sur un vrai fichier
+    char buf[64];
+    int fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    UringRead probe = { fd, buf, sizeof(buf), 0 };
+    int ok = (fd >= 0 && uring_read_batch(&probe, 1) == 0 && probe.result > 0);
+    if (fd >= 0) close(fd);
+    if (!ok) {
+        uring_close();
+        return -1;
+    }
+    return 0;
+}
+
+// Soumet un lot (n <= sq_entries) et attend toutes ses complétions
+static int run_batch(UringRead reqs[], int n) {
+    unsigned tail = *sq_tail;
+    for (int i = 0; i < n; i++) {
+        unsigned idx = tail & *sq_mask;
+        struct io_uring_sqe *sqe = &sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = reqs[i].fd;
+        sqe->addr = (unsigned long)reqs[i].buf;
+        sqe->len = reqs[i].size - 1;
+        sqe->off = 0;
+        sqe->user_data = i;
+        sq_array[idx] = idx;
+        tail++;
+    }
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+    int to_submit = n, reaped = 0;
+    while (reaped < n) {
+        int ret = sys_enter(to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            return -1;
+        }
+        to_submit -= ret;
+        if (to_submit < 0) to_submit = 0;
+
+        unsigned head = *cq_head;
+        unsigned ctail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        while (head != ctail) {
+            struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+            UringRead *r = &reqs[cqe->user_data];
+            r->result = cqe->res;
+            if (cqe->res >= 0) {
+                r->buf[cqe->res] = '\0';
+                prof_counters.bytes_read += cqe->res;
+            }
+            head++;
+            reaped++;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+int uring_read_batch(UringRead reqs[], int n) {
+    if (ring_fd < 0) return -1;
+    for (int done = 0; done < n; ) {
+        int chunk = n - done;
+        if ((unsigned)chunk > sq_entries) chunk = sq_entries;
+        if (run_batch(reqs + done, chunk) != 0) {
+            uring_close();
+            return -1;
+        }
+        done += chunk;
+    }
+    return 0;
+}
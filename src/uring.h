@@ -0,0 +1,30 @@
+#ifndef URING_H
+#define URING_H
+
+// Lectures groupées par io_uring (appels système bruts, sans liburing).
+// Une requête de lecture par fichier déjà ouvert, soumises par lots de la
+// taille de l'anneau et récoltées en un seul io_uring_enter par lot, au lieu
+// d'un pread par fichier. Si io_uring est absent (noyau < 5.6, seccomp,
+// kernel.io_uring_disabled), uring_init() échoue et l'appelant garde pread.
+
+#define URING_ENTRIES 256   // requêtes par lot
+
+typedef struct {
+    int fd;
+    char *buf;
+    int size;        // taille du tampon, un octet réservé pour le '\0'
+    int result;      // octets lus, ou -errno
+} UringRead;
+
+// Crée l'anneau et vérifie qu'une lecture passe. Retourne 0, ou -1 si indisponible.
+int uring_init(void);
+int uring_active(void);
+
+// Lit chaque reqs[i].fd à l'offset 0 (comme pread) et termine les tampons
+// par '\0'. Retourne 0, ou -1 si l'anneau est devenu inutilisable (il est
+// alors fermé et l'appelant doit relire par pread).
+int uring_read_batch(UringRead reqs[], int n);
+
+void uring_close(void);
+
+#endif